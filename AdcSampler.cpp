@@ -0,0 +1,39 @@
+#include "AdcSampler.h"
+#include <avr/sleep.h>
+
+// Only needed to wake the MCU, the result is read from ADC afterwards
+EMPTY_INTERRUPT(ADC_vect);
+
+uint8_t AdcSampler::mux(const uint8_t pin) {
+    const uint8_t channel = (pin >= A0) ? (pin - A0) : pin;
+    return _BV(REFS0) | (channel & 0x07);
+}
+
+void AdcSampler::select(const uint8_t admux) {
+    ADMUX = admux;
+}
+
+bool AdcSampler::convert(void) {
+    ADCSRA |= _BV(ADEN) | _BV(ADIE);
+
+    set_sleep_mode(SLEEP_MODE_ADC);
+
+    // Start explicitly, entering sleep only starts a conversion if none is running
+    ADCSRA |= _BV(ADSC);
+    noInterrupts();
+    if (ADCSRA & _BV(ADSC)) {
+        sleep_enable();
+        interrupts();   // sei executes the next instruction before any interrupt, so no wake up gets lost
+        sleep_cpu();
+        sleep_disable();
+    }
+    interrupts();
+
+    // Don't sleep again after another wake up, the bus may need us
+    ADCSRA &= ~_BV(ADIE);
+    return !(ADCSRA & _BV(ADSC));
+}
+
+uint16_t AdcSampler::toVcc(const uint16_t raw) {
+    return (raw > 0) ? uint16_t(BANDGAP_MV_1023 / raw) : 0;
+}
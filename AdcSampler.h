@@ -0,0 +1,31 @@
+// ADC conversions taken in ADC noise reduction sleep
+// CPU and I/O clocks are halted while the ADC converts, so the digital noise analogRead() picks up
+// from the running core is gone. Timer0 is halted too, millis() lags ~0.1ms per conversion.
+// Any other interrupt (e.g. 1-Wire pin change) may wake the MCU early. convert() then returns right away, so
+// a reset pulse is seen in time, and the conversion finishes in the background.
+
+#ifndef ADCSAMPLER_H
+#define ADCSAMPLER_H
+
+#include <Arduino.h>
+
+class AdcSampler {
+  public:
+
+    // ADMUX values for the internal channels
+    static constexpr uint8_t MUX_TEMPERATURE { _BV(REFS1) | _BV(REFS0) | 0x08 }; // 1.1V reference
+    static constexpr uint8_t MUX_BANDGAP     { _BV(REFS0) | 0x0E };              // 1.1V bandgap against AVcc
+
+    static constexpr uint32_t BANDGAP_MV_1023 { 1100UL * 1023 };  // calibrate per chip, bandgap is 1.0-1.2V
+
+    static uint8_t  mux(uint8_t pin);    // ADMUX for an analog pin (A0..A7), AVcc reference like analogRead()
+
+    // Switching to the internal reference takes milliseconds to settle (AREF capacitor),
+    // so select the channel early, keep serving the bus, and convert later
+    static void     select(uint8_t admux);
+    static bool     convert(void);       // converts the selected channel, false if woken before the result (ADC) is ready
+
+    static uint16_t toVcc(uint16_t raw); // supply voltage in mV from a MUX_BANDGAP reading
+};
+
+#endif
@@ -0,0 +1,167 @@
+#include "AdcScheduler.h"
+#include "AdcSampler.h"
+
+static_assert(uint32_t(AdcScheduler::MAX_LENGTH) * 1023 <= 0xFFFF, "MAX_LENGTH readings have to fit the 16 bit filter total");
+
+namespace {
+    constexpr uint8_t NONE { 0xFF };
+
+    struct Filter {
+        uint16_t raw;
+        uint16_t output;
+        uint16_t total;
+        bool     init;
+    };
+
+    AdcScheduler::Channel channels[AdcScheduler::MAX_CHANNELS];
+    Filter                filters[AdcScheduler::MAX_CHANNELS];
+    uint8_t               count;
+
+    uint8_t  pending;              // bit n: channel n requested
+    uint8_t  fresh;                // bit n: channel n has a result not taken yet
+
+    uint8_t  current  { NONE };    // channel being converted
+    uint8_t  selected { NONE };    // ADMUX the ADC is switched to
+    uint8_t  discards;
+    uint8_t  settle;
+    uint32_t switched;
+    bool     converting;
+    bool     sleep;
+
+    void finish(const uint16_t result) {
+        if (discards > 0) {
+            discards--;
+            return;
+        }
+
+        const uint8_t length = channels[current].length;
+        Filter &f = filters[current];
+        f.raw = result;
+        if (!f.init) {
+            // First reading, just use the one we read
+            f.output = result;
+            f.total  = result * length;
+            f.init   = true;
+        } else {
+            f.total -= f.output;
+            f.total += result;
+            f.output = f.total / length;
+        }
+
+        pending &= ~_BV(current);
+        fresh   |= _BV(current);
+        current  = NONE;
+    }
+}
+
+void AdcScheduler::begin(const bool adcSleep) {
+    sleep = adcSleep;
+}
+
+uint8_t AdcScheduler::add(const Channel &channel) {
+    if (count >= MAX_CHANNELS)
+        return NONE;
+
+    channels[count] = channel;
+    if (channel.length == 0)
+        channels[count].length = 1;
+    else if (channel.length > MAX_LENGTH)
+        channels[count].length = uint8_t(MAX_LENGTH);
+    return count++;
+}
+
+void AdcScheduler::request(const uint8_t index) {
+    if (index < count)
+        pending |= _BV(index);
+}
+
+void AdcScheduler::service(void) {
+    if (converting) {
+        if (ADCSRA & _BV(ADSC))
+            return;
+        converting = false;
+        finish(ADC);
+        return;
+    }
+
+    if (pending == 0)
+        return;
+
+    if (current == NONE) {
+        current = 0;
+        while (!(pending & _BV(current)))
+            current++;
+
+        const Channel &c = channels[current];
+        ADCSRA = (ADCSRA & ~0x07) | c.prescaler;
+        if (selected != c.admux) {
+            AdcSampler::select(c.admux);
+            selected = c.admux;
+            discards = c.discard;
+            settle   = c.settle;
+            switched = millis();
+        } else {
+            discards = 0;
+            settle   = 0;
+        }
+    }
+
+    if (settle > 0) {
+        if (millis() - switched < settle)
+            return;
+        settle = 0;
+    }
+
+    if (sleep) {
+        if (AdcSampler::convert())
+            finish(ADC);
+        else
+            converting = true;   // woken early, collected like a conversion without sleep
+    } else {
+        ADCSRA |= _BV(ADEN) | _BV(ADSC);
+        converting = true;
+    }
+}
+
+bool AdcScheduler::take(const uint8_t index) {
+    if (index >= count || !(fresh & _BV(index)))
+        return false;
+
+    fresh &= ~_BV(index);
+    return true;
+}
+
+uint16_t AdcScheduler::raw(const uint8_t index) {
+    return (index < count) ? filters[index].raw : 0;
+}
+
+uint16_t AdcScheduler::value(const uint8_t index) {
+    return (index < count) ? filters[index].output : 0;
+}
+
+uint8_t AdcScheduler::length(const uint8_t index) {
+    return (index < count) ? channels[index].length : 0;
+}
+
+void AdcScheduler::setLength(const uint8_t index, const uint8_t length) {
+    if (index >= count)
+        return;
+
+    channels[index].length = (length == 0) ? 1 : (length > MAX_LENGTH) ? uint8_t(MAX_LENGTH) : length;
+    filters[index].init    = false;
+}
+
+uint16_t AdcScheduler::getTotal(const uint8_t index) {
+    return (index < count) ? filters[index].total : 0;
+}
+
+void AdcScheduler::restore(const uint8_t index, const uint16_t output, const uint16_t total) {
+    if (index >= count)
+        return;
+
+    Filter &f = filters[index];
+    f.raw    = output;
+    f.output = output;
+    f.total  = total;
+    f.init   = true;
+}
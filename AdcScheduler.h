@@ -0,0 +1,46 @@
+// ADC channel scheduler
+// channels are requested from loop() and converted one step at a time from the poll loop, so every
+// service() call blocks for at most one conversion no matter how many channels are due. Each channel
+// has its own prescaler, settle time and discards after switching to it, and a moving average.
+// Channels are converted in the order they were added, the ADC is left on the last one.
+
+#ifndef ADCSCHEDULER_H
+#define ADCSCHEDULER_H
+
+#include <Arduino.h>
+
+class AdcScheduler {
+  public:
+
+    static constexpr uint8_t MAX_CHANNELS { 4 };
+    static constexpr uint8_t MAX_LENGTH   { 64 };   // 64 * 1023 still fits the 16 bit filter total
+
+    // ADCSRA prescaler bits, full 10 bit accuracy needs DIV_128 at 16MHz, DIV_32 still gives ~8 bits
+    enum Prescaler : uint8_t { DIV_16 = 4, DIV_32 = 5, DIV_64 = 6, DIV_128 = 7 };
+
+    struct Channel {
+        uint8_t   admux;     // see AdcSampler::MUX_* and AdcSampler::mux()
+        Prescaler prescaler;
+        uint8_t   settle;    // ms to wait after switching to this channel, for reference changes
+        uint8_t   discard;   // conversions thrown away after switching to this channel
+        uint8_t   length;    // moving average length, 1 = unfiltered
+    };
+
+    static void     begin(bool adcSleep);           // adcSleep: convert in ADC noise reduction sleep, see AdcSampler
+    static uint8_t  add(const Channel &channel);    // returns the index used by the calls below
+
+    static void     request(uint8_t index);         // convert once more
+    static void     service(void);                  // from the poll loop, at most one conversion per call
+
+    static bool     take(uint8_t index);            // true once per new result
+    static uint16_t raw(uint8_t index);             // last conversion
+    static uint16_t value(uint8_t index);           // filter output
+    static uint8_t  length(uint8_t index);
+    static void     setLength(uint8_t index, uint8_t length);  // restarts the filter
+
+    // Filter state, so it can be carried over a warm restart
+    static uint16_t getTotal(uint8_t index);
+    static void     restore(uint8_t index, uint16_t output, uint16_t total);
+};
+
+#endif
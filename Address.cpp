@@ -0,0 +1,85 @@
+#include "Address.h"
+#include "EepromLayout.h"
+#include "OneWireItem.h"
+#include <EEPROM.h>
+#include <avr/wdt.h>
+
+namespace {
+
+    constexpr uint8_t MAGIC        { 'A' };  // record: MAGIC, address, CRC8 over both
+    constexpr uint8_t LEGACY_MAGIC { '#' };  // older builds: '#', address
+
+    constexpr uint8_t SAMPLES      { 64 };   // watchdog interrupts mixed into the address, 16ms each
+
+    static_assert(Address::SIZE + 2 == EepromLayout::ADDRESS_SIZE, "Address record has to match the EEPROM layout");
+
+    volatile uint8_t pool[Address::SIZE];
+    volatile uint8_t collected;
+}
+
+// Timer0 counts at F_CPU / 64, the watchdog oscillator drifts against it, the low bits differ every time
+ISR(WDT_vect) {
+    const uint8_t sample = TCNT0;
+    const uint8_t index  = collected % Address::SIZE;
+
+    pool[index] = uint8_t((pool[index] << 3) | (pool[index] >> 5)) ^ sample;
+    ++collected;
+}
+
+bool Address::begin(uint8_t * const address) {
+    if (load(address))
+        return false;
+
+    generate(address);
+    save(address);
+    return true;
+}
+
+bool Address::load(uint8_t * const address) {
+    uint8_t record[EepromLayout::ADDRESS_SIZE];
+    for (uint8_t i = 0; i < EepromLayout::ADDRESS_SIZE; ++i)
+        record[i] = EEPROM.read(EepromLayout::ADDRESS + i);
+
+    if ((record[0] == MAGIC) && (OneWireItem::crc8(record, SIZE + 1) == record[SIZE + 1])) {
+        memcpy(address, &record[1], SIZE);
+        return true;
+    }
+
+    // Take over the address of an older build, the new record replaces it
+    if (record[0] == LEGACY_MAGIC) {
+        memcpy(address, &record[1], SIZE);
+        save(address);
+        return true;
+    }
+
+    return false;
+}
+
+void Address::save(const uint8_t * const address) {
+    uint8_t record[EepromLayout::ADDRESS_SIZE];
+    record[0] = MAGIC;
+    memcpy(&record[1], address, SIZE);
+    record[SIZE + 1] = OneWireItem::crc8(record, SIZE + 1);
+
+    for (uint8_t i = 0; i < EepromLayout::ADDRESS_SIZE; ++i)
+        EEPROM.update(EepromLayout::ADDRESS + i, record[i]);
+}
+
+void Address::generate(uint8_t * const address) {
+    collected = 0;
+
+    // Watchdog in interrupt mode only, 16ms
+    noInterrupts();
+    wdt_reset();
+    WDTCSR = _BV(WDCE) | _BV(WDE);
+    WDTCSR = _BV(WDIE);
+    interrupts();
+
+    while (collected < SAMPLES)
+        ;
+
+    wdt_disable();
+
+    for (uint8_t i = 0; i < SIZE; ++i)
+        address[i] = pool[i];
+}
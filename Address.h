@@ -0,0 +1,28 @@
+// 1-Wire address provisioning
+// the 6 serial number bytes are kept in EEPROM as a record with a CRC8. Records of older builds ('#' and
+// the address) are taken over. Without a valid record a random address is generated from the jitter
+// between the watchdog RC oscillator and the crystal clocked Timer0. That takes 64 watchdog periods of
+// 16ms, about a second, on the first boot only.
+// A master can assign an address over the bus (see DS2438New::CMD_WRITE_ADDRESS), it is stored here
+// and used from the next reset on.
+
+#ifndef ADDRESS_H
+#define ADDRESS_H
+
+#include <Arduino.h>
+
+class Address {
+  public:
+
+    static constexpr uint8_t SIZE { 6 };   // family code and ROM CRC are added by OneWireItem
+
+    static bool begin(uint8_t *address);       // load or generate, true if a new address was generated
+    static void save(const uint8_t *address);
+
+  private:
+
+    static bool load(uint8_t *address);
+    static void generate(uint8_t *address);
+};
+
+#endif
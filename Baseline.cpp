@@ -0,0 +1,121 @@
+#include "Baseline.h"
+#include "EepromLayout.h"
+#include "OneWireItem.h"
+#include <EEPROM.h>
+
+namespace {
+
+    constexpr uint8_t FRACTION_BITS { 16 };  // baseline is kept with 16 fractional bits
+    constexpr uint8_t STORED_BITS   { 6 };   // and stored with 6, so 10 bit values fit into 16
+
+    // Slot: sequence (1), baseline (2, LSB first), CRC8 (1)
+    struct Slot {
+        uint8_t sequence;
+        uint8_t value[2];
+        uint8_t crc;
+    };
+
+    static_assert(sizeof(Slot) == EepromLayout::BASELINE_SLOT, "Slot size has to match the EEPROM layout");
+
+    uint32_t baseline;   // 0: no baseline yet
+    uint32_t carry;      // bits the decay shift dropped, carried so small steps still add up
+    uint8_t  sequence;
+    uint8_t  nextSlot;
+    uint16_t sinceSave;
+
+    uint16_t slotAddress(const uint8_t slot) {
+        return EepromLayout::BASELINE + slot * EepromLayout::BASELINE_SLOT;
+    }
+
+    bool readSlot(const uint8_t slot, Slot &data) {
+        uint8_t *bytes = reinterpret_cast<uint8_t *>(&data);
+        for (uint8_t i = 0; i < sizeof(Slot); ++i)
+            bytes[i] = EEPROM.read(slotAddress(slot) + i);
+
+        return OneWireItem::crc8(bytes, sizeof(Slot) - 1) == data.crc;
+    }
+}
+
+void Baseline::begin(void) {
+    load();
+}
+
+void Baseline::load(void) {
+    // Newest slot is the last one in a run of consecutive sequence numbers
+    bool found = false;
+    Slot newest;
+
+    for (uint8_t slot = 0; slot < EepromLayout::BASELINE_SLOTS; ++slot) {
+        Slot data;
+        if (!readSlot(slot, data))
+            continue;
+
+        if (!found || (uint8_t(data.sequence - newest.sequence) < 0x80)) {
+            newest   = data;
+            nextSlot = (slot + 1) % EepromLayout::BASELINE_SLOTS;
+            found    = true;
+        }
+    }
+
+    if (!found)
+        return;
+
+    sequence = newest.sequence + 1;
+    baseline = uint32_t(newest.value[0] | (newest.value[1] << 8)) << (FRACTION_BITS - STORED_BITS);
+}
+
+void Baseline::save(void) {
+    const uint16_t value = uint16_t(baseline >> (FRACTION_BITS - STORED_BITS));
+
+    Slot data;
+    data.sequence = sequence++;
+    data.value[0] = uint8_t(value & 0xFF);
+    data.value[1] = uint8_t(value >> 8);
+    data.crc      = OneWireItem::crc8(reinterpret_cast<uint8_t *>(&data), sizeof(Slot) - 1);
+
+    const uint8_t *bytes = reinterpret_cast<uint8_t *>(&data);
+    for (uint8_t i = 0; i < sizeof(Slot); ++i)
+        EEPROM.update(slotAddress(nextSlot) + i, bytes[i]);
+
+    nextSlot = (nextSlot + 1) % EepromLayout::BASELINE_SLOTS;
+}
+
+void Baseline::update(const uint16_t value) {
+    const uint32_t scaled = uint32_t(value) << FRACTION_BITS;
+
+    if ((baseline == 0) || (scaled < baseline)) {
+        baseline = scaled;
+        carry    = 0;
+    } else {
+        const uint32_t step = (scaled - baseline) + carry;
+        baseline += step >> DECAY_SHIFT;
+        carry     = step & ((uint32_t(1) << DECAY_SHIFT) - 1);
+    }
+
+    if (++sinceSave >= SAVE_INTERVAL) {
+        sinceSave = 0;
+        save();
+    }
+}
+
+uint16_t Baseline::get(void) {
+    return uint16_t(baseline >> FRACTION_BITS);
+}
+
+uint32_t Baseline::getState(void) {
+    return baseline;
+}
+
+void Baseline::setState(const uint32_t state) {
+    if (state != 0)
+        baseline = state;
+}
+
+uint16_t Baseline::normalize(const uint16_t value) {
+    const uint16_t base = get();
+    if (base == 0)
+        return 0xFFFF;
+
+    const uint32_t ratio = (uint32_t(value) << 8) / base;
+    return (ratio > 0xFFFF) ? 0xFFFF : uint16_t(ratio);
+}
@@ -0,0 +1,34 @@
+// Long-term baseline (clean air level) tracking of the MQ135 reading
+// the baseline follows the reading down immediately and creeps up slowly (time constant
+// 2^DECAY_SHIFT readings, ~1.5 days at one reading per second), so it settles on the lowest level
+// seen over the last days. The state goes to a ring of EEPROM slots every SAVE_INTERVAL readings,
+// each slot is rewritten only every few days, and is restored at boot.
+
+#ifndef BASELINE_H
+#define BASELINE_H
+
+#include <Arduino.h>
+
+class Baseline {
+  public:
+
+    static constexpr uint8_t  DECAY_SHIFT   { 17 };
+    static constexpr uint16_t SAVE_INTERVAL { 21600 };  // readings, 6h
+
+    static void     begin(void);              // restore from EEPROM
+    static void     update(uint16_t value);   // once per reading, warm sensor only
+
+    static uint16_t get(void);                // baseline, same scale as the input
+    static uint16_t normalize(uint16_t value); // value / baseline, 256 = at baseline
+
+    // Full precision state, for a warm restart
+    static uint32_t getState(void);
+    static void     setState(uint32_t state);
+
+  private:
+
+    static void     load(void);
+    static void     save(void);
+};
+
+#endif
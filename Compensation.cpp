@@ -0,0 +1,74 @@
+#include "Compensation.h"
+
+namespace {
+
+    // Rs/R0 relative to 20degC at 33%RH, scaled by 256
+    constexpr uint16_t factorAt(const int8_t t) {
+        return uint16_t(256.0 * ((t < 20) ? (0.00035 * t * t - 0.02718 * t + 1.39538)
+                                          : (-0.003333333 * t - 0.001923077 * 33 + 1.130128205)));
+    }
+
+    #define COMPENSATION_POINT(i) factorAt(Compensation::TEMP_MIN + (i) * Compensation::TEMP_STEP)
+
+    constexpr uint16_t factors[] PROGMEM = {
+        COMPENSATION_POINT( 0), COMPENSATION_POINT( 1), COMPENSATION_POINT( 2), COMPENSATION_POINT( 3),
+        COMPENSATION_POINT( 4), COMPENSATION_POINT( 5), COMPENSATION_POINT( 6), COMPENSATION_POINT( 7),
+        COMPENSATION_POINT( 8), COMPENSATION_POINT( 9), COMPENSATION_POINT(10), COMPENSATION_POINT(11),
+        COMPENSATION_POINT(12)
+    };
+
+    #undef COMPENSATION_POINT
+
+    static_assert(sizeof(factors) / sizeof(factors[0]) == (Compensation::TEMP_MAX - Compensation::TEMP_MIN) / Compensation::TEMP_STEP + 1,
+                  "Table initializer has to match the temperature range");
+
+    // Humidity changes the factor by ~0.0019 per %RH in both branches of the fit, in 1/65536
+    constexpr int16_t HUMIDITY_SLOPE { 125 };
+
+    int8_t  temperature { 20 };
+    uint8_t humidity    { Compensation::HUMIDITY_REF };
+}
+
+int8_t Compensation::toDegC(const uint16_t raw) {
+    // T = (raw - 324.31) / 1.22, 1 / 1.22 ~ 210 / 256
+    return int8_t(((int16_t(raw) - 324) * 210) >> 8) + SENSOR_OFFSET;
+}
+
+void Compensation::setTemperature(const int8_t degC) {
+    temperature = degC;
+}
+
+int8_t Compensation::getTemperature(void) {
+    return temperature;
+}
+
+void Compensation::setHumidity(const uint8_t percent) {
+    humidity = percent;
+}
+
+uint16_t Compensation::apply(const uint16_t adc) {
+    int8_t t = temperature;
+    if (t < TEMP_MIN)
+        t = TEMP_MIN;
+    if (t > TEMP_MAX)
+        t = TEMP_MAX;
+
+    // Interpolate the factor between two table points
+    const uint8_t  index = uint8_t(t - TEMP_MIN) / TEMP_STEP;
+    const uint8_t  frac  = uint8_t(t - TEMP_MIN) % TEMP_STEP;
+    const uint16_t f0    = pgm_read_word(&factors[index]);
+    const uint16_t f1    = (frac > 0) ? pgm_read_word(&factors[index + 1]) : f0;
+    int32_t factor = f0 + (int32_t(f1) - f0) * frac / TEMP_STEP;
+
+    factor -= (int32_t(int16_t(humidity) - HUMIDITY_REF) * HUMIDITY_SLOPE) >> 8;
+    if (factor < 64)
+        factor = 64;
+
+    // Rs ~ (1023 - adc) / adc, Rs' = Rs / factor  =>  adc' = 1023 * adc * factor / ((1023 - adc) * 256 + adc * factor)
+    if (adc >= 1023)
+        return 1023;
+
+    const uint32_t numerator   = uint32_t(1023) * adc * uint32_t(factor);
+    const uint32_t denominator = uint32_t(1023 - adc) * 256 + uint32_t(adc) * uint32_t(factor);
+    return uint16_t(numerator / denominator);
+}
@@ -0,0 +1,32 @@
+// Temperature and humidity compensation of the MQ135 reading
+// the sensor resistance Rs drifts with ambient conditions, the datasheet curves are normalised to
+// 20degC / 33%RH. The correction factor is taken from a table generated at compile time from the
+// fit used by https://github.com/GeorgK/MQ135 and applied to Rs, the result is returned as the ADC
+// value the sensor would give at the reference conditions.
+
+#ifndef COMPENSATION_H
+#define COMPENSATION_H
+
+#include <Arduino.h>
+
+class Compensation {
+  public:
+
+    static constexpr int8_t  TEMP_MIN     { -10 };  // degC, table range, clamped outside
+    static constexpr int8_t  TEMP_MAX     { 50 };
+    static constexpr uint8_t TEMP_STEP    { 5 };
+    static constexpr uint8_t HUMIDITY_REF { 33 };   // %RH used when no humidity sensor is attached
+
+    // Internal temperature sensor of the ATmega328P, ~1 LSB/degC, calibrate the offset per chip
+    static constexpr int8_t  SENSOR_OFFSET { 0 };
+
+    static int8_t   toDegC(uint16_t raw);           // raw reading of AdcSampler::MUX_TEMPERATURE
+
+    static void     setTemperature(int8_t degC);
+    static int8_t   getTemperature(void);
+    static void     setHumidity(uint8_t percent);   // for an attached humidity sensor
+
+    static uint16_t apply(uint16_t adc);            // filtered ADC value in, compensated value out
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include "Config.h"
+#include "AdcScheduler.h"
+#include "EepromLayout.h"
+#include "OneWireItem.h"
+#include <EEPROM.h>
+
+static_assert(Config::SIZE + 1 == EepromLayout::CONFIG_SIZE, "Config record has to match the EEPROM layout");
+
+namespace {
+    Config::Settings settings;
+}
+
+void Config::begin(const Settings &defaults) {
+    settings = defaults;
+
+    // Record: page as on the bus, CRC8
+    uint8_t record[EepromLayout::CONFIG_SIZE];
+    for (uint8_t i = 0; i < EepromLayout::CONFIG_SIZE; ++i)
+        record[i] = EEPROM.read(EepromLayout::CONFIG + i);
+
+    if (OneWireItem::crc8(record, SIZE) != record[SIZE])
+        return;
+
+    Settings stored;
+    if (fromPage(record, stored))
+        settings = stored;
+}
+
+const Config::Settings & Config::get(void) {
+    return settings;
+}
+
+bool Config::set(const uint8_t * const page) {
+    Settings changed;
+    if (!fromPage(page, changed))
+        return false;
+
+    settings = changed;
+    save();
+    return true;
+}
+
+void Config::toPage(uint8_t * const page) {
+    page[0] = VERSION;
+    page[1] = uint8_t(settings.readingInterval & 0xFF);
+    page[2] = uint8_t(settings.readingInterval >> 8);
+    page[3] = settings.filterLength;
+    page[4] = uint8_t(settings.initDelay & 0xFF);
+    page[5] = uint8_t(settings.initDelay >> 8);
+    page[6] = settings.flags;
+    page[7] = 0;
+}
+
+bool Config::fromPage(const uint8_t * const page, Settings &result) {
+    if (page[0] != VERSION)
+        return false;
+
+    result.readingInterval = page[1] | (page[2] << 8);
+    result.filterLength    = page[3];
+    result.initDelay       = page[4] | (page[5] << 8);
+    result.flags           = page[6];
+
+    return (result.readingInterval >= MIN_INTERVAL) && (result.readingInterval <= MAX_INTERVAL)
+        && (result.filterLength >= 1) && (result.filterLength <= AdcScheduler::MAX_LENGTH);
+}
+
+void Config::save(void) {
+    uint8_t record[EepromLayout::CONFIG_SIZE];
+    toPage(record);
+    record[SIZE] = OneWireItem::crc8(record, SIZE);
+
+    for (uint8_t i = 0; i < EepromLayout::CONFIG_SIZE; ++i)
+        EEPROM.update(EepromLayout::CONFIG + i, record[i]);
+}
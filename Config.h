@@ -0,0 +1,46 @@
+// Node configuration, kept in EEPROM and mirrored in DS2438 page 7
+// the compile-time settings are only the defaults. A master changes them by writing page 7 with Write
+// Scratchpad and committing it with Copy Scratchpad, like the real device's EEPROM pages:
+//   byte 0     layout version, has to be VERSION
+//   bytes 1-2  reading interval in ms, LSB first (MIN_INTERVAL to MAX_INTERVAL)
+//   byte 3     moving average length in readings (1 to AdcScheduler::MAX_LENGTH)
+//   bytes 4-5  init delay in s, LSB first
+//   byte 6     bit 0: status LED off
+//   byte 7     reserved, 0
+// Invalid pages are ignored, page 7 then shows the settings in effect again.
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <Arduino.h>
+
+class Config {
+  public:
+
+    static constexpr uint8_t  VERSION      { 1 };
+    static constexpr uint8_t  SIZE         { 8 };    // one DS2438 page
+    static constexpr uint16_t MIN_INTERVAL { 100 };  // ms
+    static constexpr uint16_t MAX_INTERVAL { 3000 }; // ms, has to stay below the sketch's WATCHDOG_TICK
+
+    static constexpr uint8_t  FLAG_LED_OFF { 0x01 };
+
+    struct Settings {
+        uint16_t readingInterval;  // ms
+        uint8_t  filterLength;     // readings
+        uint16_t initDelay;        // s
+        uint8_t  flags;            // see FLAG_*
+    };
+
+    static void begin(const Settings &defaults);   // load from EEPROM, defaults if there is nothing valid
+    static const Settings & get(void);
+
+    static bool set(const uint8_t *page);          // validate, apply and persist a page written by the master
+    static void toPage(uint8_t *page);
+
+  private:
+
+    static bool fromPage(const uint8_t *page, Settings &settings);
+    static void save(void);
+};
+
+#endif
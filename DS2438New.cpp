@@ -6,74 +6,180 @@ DS2438New::DS2438New(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t
 }
 
 void DS2438New::duty(OneWireHub * const hub) {
-    uint8_t page, cmd;
+    const uint32_t start = micros();
+
+    uint8_t cmd;
     if (hub->recv(&cmd, 1))
         return;
 
+    lastCommand = millis();
+    command(hub, cmd);
+
+    // log2 histogram of the service time, first bucket is everything below 128us
+    uint32_t time   = (micros() - start) >> 7;
+    uint8_t  bucket = 0;
+    while (time && (bucket < STATS_BUCKETS - 1)) {
+        time >>= 1;
+        ++bucket;
+    }
+
+    if (stats.dutyTime[bucket] < 0xFF)
+        ++stats.dutyTime[bucket];
+}
+
+void DS2438New::command(OneWireHub * const hub, const uint8_t cmd) {
+    uint8_t page;
+
     switch (cmd) {
         // Read Scratchpad
         case 0xBE:      
+            ++stats.commands[0];
+
             if (hub->recv(&page))
               return;
 
             if (page >= PAGE_COUNT)
               return;
               
-            if (hub->send(&memory[page * 8], 8))
+            if (hub->send(&memory[page * PAGE_SIZE], PAGE_SIZE))
               return;
 
             if (hub->send(crc[page]))
               return;
 
+            // Master has seen the latest data, nothing changed since
+            if (page == 0)
+                clearChanged();
+
+            break;
+
+        // Read Pages (vendor extension)
+        case CMD_READ_PAGES:
+        {
+            ++stats.commands[1];
+
+            uint8_t mask;
+            if (hub->recv(&mask))
+                return;
+
+            // CRC covers command, mask and all page data, like the CRC16 of the Maxim memory commands
+            uint16_t crc_bulk = crc16(&cmd, 1);
+            crc_bulk = crc16(&mask, 1, crc_bulk);
+
+            if (mask == 0)
+                mask = bulkPages;
+
+            for (page = 0; page < PAGE_COUNT; ++page) {
+                if (!(mask & (1 << page)))
+                    continue;
+
+                if (hub->send(&memory[page * PAGE_SIZE], PAGE_SIZE, crc_bulk))
+                    return;
+            }
+
+            crc_bulk = ~crc_bulk;
+            if (hub->send(reinterpret_cast<uint8_t *>(&crc_bulk), 2))
+                return;
+
+            if (mask & 0x01)
+                clearChanged();
+
+            break;
+        }
+
+        // Write Address (vendor extension), the application stores it for the next reset
+        case CMD_WRITE_ADDRESS:
+        {
+            if (!addressCommand) {
+                ++stats.slaveErrors;
+                hub->raiseSlaveError(cmd);
+                break;
+            }
+
+            uint8_t data[sizeof(addressRequest) + 1];
+            if (hub->recv(data, sizeof(data)))
+                return;
+
+            if (crc8(data, sizeof(addressRequest)) != data[sizeof(addressRequest)])
+                return;
+
+            memcpy(addressRequest, data, sizeof(addressRequest));
+            addressPending = true;
+
+            hub->send(0xAA);
             break;
+        }
 
         // Write Scratchpad
-        case 0x4E:      
+        case 0x4E:
+        {
+            ++stats.commands[2];
+
             if (hub->recv(&page))
                 return;
 
             if (page >= PAGE_COUNT)
                 return;
 
-            for (uint8_t nByte = page<<3; nByte < (page+1)<<3; ++nByte) {
+            const uint8_t readonly = readOnly(page);
+            for (uint8_t nByte = 0; nByte < PAGE_SIZE; ++nByte) {
                 uint8_t data;
                 // Data sending finished
                 if (hub->recv(&data, 1))
                     break;
 
-                // Bytes 1-6 are read only
-                if ((nByte < 7) && (nByte > 0))
-                    continue; 
-                  
-                memory[nByte] = data;
+                // Measurements, sequence and flags are maintained by the device
+                if (readonly & (1 << nByte))
+                    continue;
+
+                memory[page * PAGE_SIZE + nByte] = data;
             }
 
+            // New selector written
+            if (page == DIAG_PAGE)
+                updateDiagnostics();
+
             // Calculate CRC
             calcCRC(page);
             break;
+        }
 
         // Copy scratchpad
         case 0x48:
+            ++stats.commands[3];
+
             if (hub->recv(&page, 1))
                 return;
 
             if (page >= PAGE_COUNT)
               return;
 
+            // No EEPROM here, the application picks the page up and stores it
+            copyRequests |= (1 << page);
             break;
 
         // Recall Memory
         case 0xB8:
+            ++stats.commands[4];
+
             if (hub->recv(&page, 1))
                 return;
 
             if (page >= PAGE_COUNT)
               return;
-            
+
+            // Take a fresh snapshot, like the real device copies EEPROM to the scratchpad
+            if (page == DIAG_PAGE) {
+                updateDiagnostics();
+                calcCRC(page);
+            }
+
             break;
 
         // Convert T
         case 0x44:
+            ++stats.commands[5];
+
             // Calculate CRC
             calcCRC(0);
             
@@ -81,15 +187,18 @@ void DS2438New::duty(OneWireHub * const hub) {
 
         // Convert V
         case 0xB4:
+            ++stats.commands[6];
+
             // Update voltage depending on request
-            updateVoltage(0);
-            
+            updateVoltage();
+
             // Calculate CRC
-            calcCRC(0);
+            updateCRC();
             
             break;
 
         default:
+            ++stats.slaveErrors;
             hub->raiseSlaveError(cmd);
             break;
     }
@@ -97,25 +206,52 @@ void DS2438New::duty(OneWireHub * const hub) {
 
 void DS2438New::calcCRC(const uint8_t page) {
     if (page  < PAGE_COUNT)
-        crc[page] = crc8(&memory[page * 8], 8);
+        crc[page] = crc8(&memory[page * PAGE_SIZE], PAGE_SIZE);
 }
 
-void DS2438New::updateVoltage(const uint8_t page) {
-    uint8_t isVDD = memory[page * 8] & REG0_MASK_AD;
-    memory[page * 8 + 3] = (isVDD)?vddVoltage[0]:vadVoltage[0];
-    memory[page * 8 + 4] = (isVDD)?vddVoltage[1]:vadVoltage[1];
+void DS2438New::updateCRC(void) {
+    for (uint8_t page = 0; dirtyPages; ++page, dirtyPages >>= 1)
+        if (dirtyPages & 0x01)
+            calcCRC(page);
+}
+
+void DS2438New::updateVoltage(void) {
+    const bool isVDD = get<REG_STATUS>() & REG0_MASK_AD;
+    set<REG_VOLTAGE>((isVDD) ? vddVoltage : vadVoltage);
 }
 
 void DS2438New::clearMemory(void) {
     memcpy(memory, MemDS2438, (PAGE_COUNT*PAGE_SIZE));
 
     memory[0] |= REG0_MASK_IAD;  // enable automatic current measurements
-    memory[0] |= REG0_MASK_CA;   // enable current accumulator (page7, byte 4-7)
+    memory[0] &= ~REG0_MASK_CA;  // no current accumulator, page 7 holds the node's configuration
     memory[0] &= ~REG0_MASK_AD;  // 1: battery voltage, 0: ADC-GPIO
     memory[0] &= ~REG0_MASK_TB;  // temperature busy flag
     memory[0] &= ~REG0_MASK_NVB; // eeprom busy flag
     memory[0] &= ~REG0_MASK_ADB; // adc busy flag
 
+    set<REG_SEQUENCE>(0);
+    set<REG_FLAGS>(0);
+    set<REG_DEADBAND>(0);  // publish every change
+
+    memset(&memory[2 * PAGE_SIZE], 0, PAGE_SIZE); // threshold engine disabled
+
+    memset(&memory[3 * PAGE_SIZE], 0, PAGE_SIZE);
+    memset(&memory[DIAG_PAGE * PAGE_SIZE], 0, PAGE_SIZE);
+    diagnosticsHandler = nullptr;
+    clearStats();
+
+    vadVoltage   = 0;
+    vddVoltage   = 0;
+    vadPublished = 0;
+    bulkPages    = 0x01;
+    dirtyPages   = 0;
+    lastCommand  = 0;
+    copyRequests = 0;
+
+    addressCommand = false;
+    addressPending = false;
+
     for (uint8_t page = 0; page < PAGE_COUNT; ++page)
         calcCRC(page);
 }
@@ -154,10 +290,7 @@ void DS2438New::setTemperature(const float temp_degC) {
     if (value < -55*256)
         value = -55*256;
 
-    memory[1] = static_cast<uint8_t>(value&0xF8);
-    memory[2] = uint8_t(value >> 8);
-
-    calcCRC(0);
+    updateTemperature(static_cast<uint16_t>(value & 0xFFF8));
 }
 
 void DS2438New::setTemperature(const int8_t temp_degC) {
@@ -168,44 +301,210 @@ void DS2438New::setTemperature(const int8_t temp_degC) {
     if (value < -55)
         value = -55;
 
-    memory[1] = 0;
-    memory[2] = static_cast<uint8_t>(value);
+    updateTemperature(static_cast<uint16_t>(static_cast<uint8_t>(value) << 8));
+}
 
-    calcCRC(0);
+void DS2438New::updateTemperature(const uint16_t value) {
+    // Page 0 changed, masters polling the sequence have to see it
+    if (value != get<REG_TEMP>()) {
+        set<REG_TEMP>(value);
+        publishChange();
+    }
+    updateCRC();
 }
 
 int8_t DS2438New::getTemperature() const {
-    return memory[2];
+    return static_cast<int8_t>(get<REG_TEMP>() >> 8);
 }
 
 
+void DS2438New::publishChange(void) {
+    set<REG_SEQUENCE>(uint8_t(get<REG_SEQUENCE>() + 1));
+    set<REG_FLAGS>(get<REG_FLAGS>() | REG1_MASK_CHG);
+}
+
+void DS2438New::clearChanged(void) {
+    if (get<REG_FLAGS>() & REG1_MASK_CHG) {
+        set<REG_FLAGS>(get<REG_FLAGS>() & ~REG1_MASK_CHG);
+        updateCRC();
+    }
+}
+
+void DS2438New::updateAlarm(const uint16_t value) {
+    const uint8_t flags = get<REG_FLAGS>();
+    uint8_t alarm = flags & REG1_MASK_ALM;
+
+    if (!(get<REG_ALARM_CTL>() & REG2_MASK_EN))
+        alarm = 0;
+    else if (value >= get<REG_ALARM_SET>())
+        alarm = REG1_MASK_ALM;
+    else if (value <= get<REG_ALARM_CLR>())
+        alarm = 0;
+
+    // Entering or leaving alarm is a change masters want to know about
+    if (alarm != (flags & REG1_MASK_ALM)) {
+        set<REG_FLAGS>((flags & ~REG1_MASK_ALM) | alarm);
+        publishChange();
+    }
+}
+
 void DS2438New::setVADVoltage(const uint16_t voltage_10mV) {
-    vadVoltage[0] = uint8_t(voltage_10mV & 0xFF);
-    vadVoltage[1] = uint8_t((voltage_10mV >> 8) & static_cast<uint8_t>(0x03));
+    vadVoltage = voltage_10mV & 0x03FF;
+
+    updateAlarm(vadVoltage);
+
+    const uint16_t delta = (vadVoltage > vadPublished) ? (vadVoltage - vadPublished) : (vadPublished - vadVoltage);
+    if (delta > get<REG_DEADBAND>()) {
+        vadPublished = vadVoltage;
+        publishChange();
+    }
+
+    updateCRC();
 }
 
 uint16_t DS2438New::getVADVoltage(void) const {
-    return ((vadVoltage[1]<<8) | vadVoltage[0]);
+    return vadVoltage;
 }
 
 void DS2438New::setVDDVoltage(const uint16_t voltage_10mV) {
-    vddVoltage[0] = uint8_t(voltage_10mV & 0xFF);
-    vddVoltage[1] = uint8_t((voltage_10mV >> 8) & static_cast<uint8_t>(0x03));
+    vddVoltage = voltage_10mV & 0x03FF;
 }
 
 uint16_t DS2438New::getVDDVoltage(void) const {
-    return ((vddVoltage[1]<<8) | vddVoltage[0]);
+    return vddVoltage;
 }
 
 void DS2438New::setCurrent(const int16_t value) {
-    memory[5] = uint8_t(value & 0xFF);
-    memory[6] = uint8_t((value >> 8) & static_cast<uint8_t>(0x03));
-    if (value < 0)
-        memory[6] |= 0xFC; // all upper bits (7:2) are the signum
-    
-    calcCRC(0);
+    set<REG_CURRENT>(static_cast<uint16_t>(value));
+    updateCRC();
 }
 
 int16_t DS2438New::getCurrent(void) const {
-    return ((memory[6]<<8) | memory[5]);
-}
+    return static_cast<int16_t>(get<REG_CURRENT>());
+}
+
+void DS2438New::setPpm(const uint16_t ppm) {
+    set<REG_PPM>(ppm);
+    updateCRC();
+}
+
+uint16_t DS2438New::getPpm(void) const {
+    return get<REG_PPM>();
+}
+
+void DS2438New::setCompensated(const uint16_t value) {
+    set<REG_COMP>(value);
+    updateCRC();
+}
+
+uint16_t DS2438New::getCompensated(void) const {
+    return get<REG_COMP>();
+}
+
+void DS2438New::setBaseline(const uint16_t baseline, const uint16_t normalized) {
+    set<REG_BASELINE>(baseline);
+    set<REG_NORMAL>(normalized);
+    updateCRC();
+}
+
+uint16_t DS2438New::getBaseline(void) const {
+    return get<REG_BASELINE>();
+}
+
+uint16_t DS2438New::getNormalized(void) const {
+    return get<REG_NORMAL>();
+}
+
+void DS2438New::setDeadband(const uint8_t voltage_10mV) {
+    set<REG_DEADBAND>(voltage_10mV);
+    updateCRC();
+}
+
+uint8_t DS2438New::getDeadband(void) const {
+    return get<REG_DEADBAND>();
+}
+
+uint8_t DS2438New::getSequence(void) const {
+    return get<REG_SEQUENCE>();
+}
+
+bool DS2438New::getChanged(void) const {
+    return (get<REG_FLAGS>() & REG1_MASK_CHG) != 0;
+}
+
+void DS2438New::setAlarmThresholds(const uint16_t set_10mV, const uint16_t clear_10mV) {
+    set<REG_ALARM_SET>(set_10mV);
+    set<REG_ALARM_CLR>(clear_10mV);
+    set<REG_ALARM_CTL>(get<REG_ALARM_CTL>() | REG2_MASK_EN);
+    updateCRC();
+}
+
+bool DS2438New::getAlarm(void) const {
+    return (get<REG_FLAGS>() & REG1_MASK_ALM) != 0;
+}
+
+void DS2438New::setBulkPages(const uint8_t page_mask) {
+    bulkPages = page_mask;
+}
+
+uint8_t DS2438New::getBulkPages(void) const {
+    return bulkPages;
+}
+
+uint32_t DS2438New::getLastCommandTime(void) const {
+    return lastCommand;
+}
+
+void DS2438New::setConfig(const uint8_t * const data) {
+    memcpy(&memory[CONFIG_PAGE * PAGE_SIZE], data, CONFIG_SIZE);
+    calcCRC(CONFIG_PAGE);
+}
+
+void DS2438New::getConfig(uint8_t * const data) const {
+    memcpy(data, &memory[CONFIG_PAGE * PAGE_SIZE], CONFIG_SIZE);
+}
+
+uint8_t DS2438New::takeCopyRequests(void) {
+    const uint8_t requests = copyRequests;
+    copyRequests = 0;
+    return requests;
+}
+
+void DS2438New::enableAddressCommand(const bool enable) {
+    addressCommand = enable;
+}
+
+bool DS2438New::takeAddressRequest(uint8_t * const address) {
+    if (!addressPending)
+        return false;
+
+    memcpy(address, addressRequest, sizeof(addressRequest));
+    addressPending = false;
+    return true;
+}
+
+void DS2438New::updateDiagnostics(void) {
+    uint8_t * const data = &memory[DIAG_PAGE * PAGE_SIZE];
+
+    memset(&data[1], 0, PAGE_SIZE - 1);
+    if (diagnosticsHandler != nullptr)
+        diagnosticsHandler(data[0] & ~DIAG_MASK_CLEAR, &data[1]);
+
+    // Master asked to start counting from zero again
+    if (data[0] & DIAG_MASK_CLEAR) {
+        data[0] &= ~DIAG_MASK_CLEAR;
+        clearStats();
+    }
+}
+
+void DS2438New::setDiagnosticsHandler(const DiagnosticsHandler handler) {
+    diagnosticsHandler = handler;
+}
+
+const DS2438New::Stats & DS2438New::getStats(void) const {
+    return stats;
+}
+
+void DS2438New::clearStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
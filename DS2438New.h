@@ -38,19 +38,136 @@ class DS2438New : public OneWireItem {
     static constexpr uint8_t REG0_MASK_NVB  { 0x20 }; // eeprom busy flag
     static constexpr uint8_t REG0_MASK_ADB  { 0x40 }; // adc busy flag
 
+    static constexpr uint8_t REG1_MASK_CHG  { 0x01 }; // page 0 changed since it was last read completely
+    static constexpr uint8_t REG1_MASK_ALM  { 0x02 }; // VAD is in alarm, see page 2
+
+    static constexpr uint8_t REG2_MASK_EN   { 0x01 }; // enable threshold engine
+
+    // Page 6 is a diagnostics window: byte 0 selects what bytes 1-7 show, they are refreshed
+    // when the selector is written and on Recall Memory
+    static constexpr uint8_t DIAG_PAGE       { 6 };
+    static constexpr uint8_t DIAG_MASK_CLEAR { 0x80 }; // selector bit: clear statistics after the snapshot
+
+    enum class Encoding : uint8_t { UNSIGNED, SIGNED }; // SIGNED: bits above MSB_MASK carry the signum
+
+    // Register field, little endian, 1 or 2 bytes. Everything is resolved at compile time
+    template<uint8_t OFFSET, uint8_t WIDTH, uint8_t MSB_MASK = 0xFF, Encoding ENCODING = Encoding::UNSIGNED>
+    struct Field {
+        static_assert((WIDTH == 1) || (WIDTH == 2), "Fields are 1 or 2 bytes wide");
+        static_assert(OFFSET + WIDTH <= MEM_SIZE, "Field is outside of the emulated pages");
+
+        static constexpr uint8_t  offset   { OFFSET };
+        static constexpr uint8_t  width    { WIDTH };
+        static constexpr uint8_t  msbMask  { MSB_MASK };
+        static constexpr Encoding encoding { ENCODING };
+        static constexpr uint8_t  dirty    { uint8_t((1 << (OFFSET / PAGE_SIZE)) | (1 << ((OFFSET + WIDTH - 1) / PAGE_SIZE))) };
+
+        // bit n is set if byte n of the page belongs to this field
+        static constexpr uint8_t bytesIn(const uint8_t page) {
+            return (page == OFFSET / PAGE_SIZE)               ? uint8_t(((1 << WIDTH) - 1) << (OFFSET % PAGE_SIZE))
+                 : (page == (OFFSET + WIDTH - 1) / PAGE_SIZE) ? uint8_t((((1 << WIDTH) - 1) << (OFFSET % PAGE_SIZE)) >> PAGE_SIZE)
+                 : 0;
+        }
+    };
+
+    // Page 0, as in the datasheet
+    using REG_STATUS    = Field< 0, 1>;
+    using REG_TEMP      = Field< 1, 2>;                          // 1/256 degC, lowest 3 bits unused
+    using REG_VOLTAGE   = Field< 3, 2, 0x03>;                    // VAD or VDD in 10mV, see REG0_MASK_AD
+    using REG_CURRENT   = Field< 5, 2, 0x03, Encoding::SIGNED>;
+
+    // Page 1 is reused as status page, so masters can poll it cheaply (read 2 bytes, then reset)
+    using REG_SEQUENCE  = Field< 8, 1>;                          // data-generation counter, bumped on every published change
+    using REG_FLAGS     = Field< 9, 1>;                          // status flags, see REG1_MASK_*
+    using REG_DEADBAND  = Field<10, 1>;                          // min. change of VAD (in 10mV steps) before a change is published
+
+    // Page 2 configures the threshold engine behind the alarm flag
+    using REG_ALARM_SET = Field<16, 2>;                          // VAD at or above this raises the alarm
+    using REG_ALARM_CLR = Field<18, 2>;                          // VAD at or below this clears it again (hysteresis)
+    using REG_ALARM_CTL = Field<20, 1>;                          // see REG2_MASK_*
+
+    // Page 3 holds values derived on the node
+    using REG_PPM       = Field<24, 2>;                          // ppm from the MQ135 curve, saturates at 65535
+    using REG_COMP      = Field<26, 2, 0x03>;                    // VAD compensated to 20degC / 33%RH
+    using REG_NORMAL    = Field<28, 2>;                          // value / baseline, 256 = clean air
+    using REG_BASELINE  = Field<30, 2, 0x03>;                    // long-term clean air level, VAD scale
+
+    using REG_DIAG_SEL  = Field<48, 1>;                          // diagnostics selector, see DIAG_PAGE
+
+    // Bytes of a page the master can't change with Write Scratchpad
+    static constexpr uint8_t readOnly(const uint8_t page) {
+        return uint8_t(REG_TEMP::bytesIn(page) | REG_VOLTAGE::bytesIn(page) | REG_CURRENT::bytesIn(page)
+                     | REG_SEQUENCE::bytesIn(page) | REG_FLAGS::bytesIn(page) | REG_PPM::bytesIn(page)
+                     | REG_COMP::bytesIn(page) | REG_NORMAL::bytesIn(page) | REG_BASELINE::bytesIn(page)
+                     | ((page == DIAG_PAGE) ? uint8_t(~REG_DIAG_SEL::bytesIn(page)) : 0));
+    }
+
+public:
+
+    static constexpr uint8_t STATS_COMMANDS { 7 }; // 0xBE, 0xBA, 0x4E, 0x48, 0xB8, 0x44, 0xB4
+    static constexpr uint8_t STATS_BUCKETS  { 7 }; // <128us, <256us, ... <4ms, longer
+
+    struct Stats {
+        uint8_t  commands[STATS_COMMANDS];  // per opcode, wrapping
+        uint8_t  dutyTime[STATS_BUCKETS];   // duty() service time, saturating
+        uint16_t slaveErrors;               // unknown commands
+    };
+
+    // Fills the 7 data bytes of the diagnostics page for a selector
+    typedef void (*DiagnosticsHandler)(uint8_t selector, uint8_t *data);
+
+private:
+
+    Stats              stats;
+    DiagnosticsHandler diagnosticsHandler;
+
     uint8_t memory[MEM_SIZE];  // this mem is the "scratchpad" in the datasheet., no EEPROM implemented
     uint8_t crc[PAGE_COUNT+1]; // keep the matching crc for each memory-page, reading can be very timesensitive
 
-    uint8_t vadVoltage[2];
-    uint8_t vddVoltage[2];
+    uint8_t  dirtyPages;       // pages changed since their crc was calculated
+
+    uint16_t vadVoltage;
+    uint16_t vddVoltage;
+
+    uint16_t vadPublished;     // VAD value the current sequence number stands for
+    uint8_t  bulkPages;        // pages streamed by Read Pages when the master asks for the default set
+
+    uint32_t lastCommand;      // millis() of the last command addressed to us
+    uint8_t  copyRequests;     // bit n: Copy Scratchpad for page n since the last takeCopyRequests()
+
+    bool     addressCommand;   // CMD_WRITE_ADDRESS is answered
+    bool     addressPending;
+    uint8_t  addressRequest[6];
+
+    template<class FIELD>
+    void     set(uint16_t value);
+
+    template<class FIELD>
+    uint16_t get(void) const;
+
+    void command(OneWireHub * hub, uint8_t cmd);
+    void updateDiagnostics(void);
 
     void calcCRC(uint8_t page);
-    void updateVoltage(uint8_t page);
+    void updateCRC(void);
+    void updateVoltage(void);
+    void updateTemperature(uint16_t value);
+    void publishChange(void);
+    void updateAlarm(uint16_t value);
+    void clearChanged(void);
 
 public:
 
     static constexpr uint8_t family_code    { 0x26 };
 
+    static constexpr uint8_t CMD_READ_PAGES { 0xBA }; // vendor extension: mask byte, then selected pages and one CRC16
+
+    static constexpr uint8_t CMD_WRITE_ADDRESS { 0xD5 }; // vendor extension: 6 address bytes and their CRC8, answered with 0xAA
+
+    // Page 7 holds the node's configuration, the device only keeps it and reports Copy Scratchpad
+    static constexpr uint8_t CONFIG_PAGE    { 7 };
+    static constexpr uint8_t CONFIG_SIZE    { PAGE_SIZE };
+
     DS2438New(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
 
     void     duty(OneWireHub * hub) final;
@@ -72,6 +189,58 @@ public:
 
     void     setCurrent(int16_t value);  // signed 11 bit
     int16_t  getCurrent(void) const;
+
+    void     setPpm(uint16_t ppm);
+    uint16_t getPpm(void) const;
+
+    void     setCompensated(uint16_t value);  // unsigned 10 bit, same scale as VAD
+    uint16_t getCompensated(void) const;
+
+    void     setBaseline(uint16_t baseline, uint16_t normalized);
+    uint16_t getBaseline(void) const;
+    uint16_t getNormalized(void) const;
+
+    void     setDeadband(uint8_t voltage_10mV); // VAD changes up to this size don't bump the sequence
+    uint8_t  getDeadband(void) const;
+
+    uint8_t  getSequence(void) const;
+    bool     getChanged(void) const;
+
+    void     setAlarmThresholds(uint16_t set_10mV, uint16_t clear_10mV); // clear has to be below set
+    bool     getAlarm(void) const; // VAD is in alarm, REG1_MASK_ALM in page 1
+
+    void     setBulkPages(uint8_t page_mask); // bit n selects page n for Read Pages with mask 0
+    uint8_t  getBulkPages(void) const;
+
+    uint32_t getLastCommandTime(void) const;  // millis() of the last command, 0 if there was none yet
+
+    void     setConfig(const uint8_t *data);   // CONFIG_SIZE bytes shown in CONFIG_PAGE
+    void     getConfig(uint8_t *data) const;
+    uint8_t  takeCopyRequests(void);          // pages committed with Copy Scratchpad since the last call, bit n = page n
+
+    void     enableAddressCommand(bool enable);
+    bool     takeAddressRequest(uint8_t *address); // true once per address assigned with CMD_WRITE_ADDRESS
+
+    void     setDiagnosticsHandler(DiagnosticsHandler handler);
+    const Stats & getStats(void) const;
+    void     clearStats(void);
 };
 
+template<class FIELD>
+inline void DS2438New::set(const uint16_t value) {
+    memory[FIELD::offset] = uint8_t(value & 0xFF);
+    if (FIELD::width > 1) {
+        uint8_t msb = uint8_t(value >> 8) & FIELD::msbMask;
+        if ((FIELD::encoding == Encoding::SIGNED) && (value & 0x8000))
+            msb |= uint8_t(~FIELD::msbMask);
+        memory[FIELD::offset + 1] = msb;
+    }
+    dirtyPages |= FIELD::dirty;
+}
+
+template<class FIELD>
+inline uint16_t DS2438New::get(void) const {
+    return (FIELD::width > 1) ? ((memory[FIELD::offset + 1] << 8) | memory[FIELD::offset]) : memory[FIELD::offset];
+}
+
 #endif
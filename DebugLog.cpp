@@ -0,0 +1,33 @@
+#include "DebugLog.h"
+
+DebugLog::DebugLog(void) : head(0), tail(0), dropped(0) {
+}
+
+size_t DebugLog::write(const uint8_t value) {
+    const uint8_t next = (head + 1) & (BUFFER_SIZE - 1);
+    if (next == tail) {
+        if (dropped < 0xFFFF)
+            ++dropped;
+        return 0;
+    }
+
+    buffer[head] = value;
+    head = next;
+    return 1;
+}
+
+void DebugLog::pump(void) {
+    int room = Serial.availableForWrite();
+    while ((tail != head) && (room-- > 0)) {
+        Serial.write(buffer[tail]);
+        tail = (tail + 1) & (BUFFER_SIZE - 1);
+    }
+}
+
+uint8_t DebugLog::room(void) const {
+    return (tail - head - 1) & (BUFFER_SIZE - 1);
+}
+
+uint16_t DebugLog::getDropped(void) const {
+    return dropped;
+}
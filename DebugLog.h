@@ -0,0 +1,38 @@
+// Non-blocking debug output
+// prints go into a ring buffer, pump() moves them on to Serial only as far as its TX buffer has room,
+// the UART TX interrupt does the rest. When the ring is full new bytes are dropped and counted,
+// so logging never stalls hub.poll() or changes bus timing.
+
+#ifndef DEBUGLOG_H
+#define DEBUGLOG_H
+
+#include <Arduino.h>
+
+class DebugLog : public Print {
+  private:
+
+    static constexpr uint8_t BUFFER_SIZE { 128 };
+    static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "Buffer size has to be a power of 2");
+
+    uint8_t  buffer[BUFFER_SIZE];
+    uint8_t  head;      // next byte to write
+    uint8_t  tail;      // next byte to send
+    uint16_t dropped;
+
+  public:
+
+    DebugLog(void);
+
+    size_t   write(uint8_t value) override;
+    using Print::write;
+
+    void     pump(void);            // call often, e.g. next to hub.poll()
+
+    uint8_t  room(void) const;      // bytes that can be written without dropping any
+
+    uint16_t getDropped(void) const;
+};
+
+extern DebugLog Log;  // defined by the sketch, so it costs no RAM when unused
+
+#endif
@@ -0,0 +1,183 @@
+#include "Diagnostics.h"
+#include <avr/wdt.h>
+
+// Linker symbols for the RAM layout
+extern uint8_t __heap_start;
+extern uint8_t *__brkval;
+
+namespace {
+
+    constexpr uint8_t STACK_PAINT { 0xC5 };
+
+    // Written before main(), see paintStack()
+    uint8_t  resetCause __attribute__ ((section (".noinit")));
+    uint8_t  bootCause  __attribute__ ((section (".noinit")));  // r2, only meaningful with Optiboot
+
+    DS2438New *device;
+
+    // Running counters of the current interval
+    uint32_t intervalStart;
+    uint32_t lastPoll;
+    uint16_t iterations;
+    uint16_t maxGap;
+
+    // Results of the last complete interval
+    uint16_t pollRate;
+    uint16_t pollGap;
+    uint16_t stackFree;
+    uint16_t logDropped;
+
+    uint8_t  stuckStage;
+    uint16_t watchdogResets;
+
+    uint16_t lastRaw;
+    uint16_t lastFiltered;
+    uint8_t  filterLength;
+    uint16_t samples;
+
+    void put16(uint8_t * const data, const uint16_t value) {
+        data[0] = uint8_t(value & 0xFF);
+        data[1] = uint8_t(value >> 8);
+    }
+}
+
+// Runs before the C runtime sets up .data/.bss, the stack is still empty: paint everything above .bss
+// so the deepest stack use can be found later. Also keep the reset cause before anyone clears MCUSR,
+// and stop the watchdog, it stays enabled with the shortest timeout after a watchdog reset.
+// The host build (extras/host) calls it from main() instead.
+#ifdef __AVR__
+  void paintStack(void) __attribute__ ((naked, used, section (".init3")));
+#endif
+void paintStack(void) {
+    resetCause = MCUSR;
+    MCUSR      = 0;
+    wdt_disable();
+
+    // Optiboot clears MCUSR itself and hands the cause over in r2, other bootloaders leave junk there.
+    // Keep it aside, the sketch decides whether to trust it
+    bootCause = 0;
+    #ifdef __AVR__
+      __asm__ __volatile__ ("mov %0, r2" : "=r" (bootCause));
+    #endif
+
+    for (uint8_t *p = &__heap_start; p < (uint8_t *) RAMEND; ++p)
+        *p = STACK_PAINT;
+}
+
+void Diagnostics::attach(DS2438New &ds2438) {
+    device = &ds2438;
+    device->setDiagnosticsHandler(fill);
+}
+
+void Diagnostics::poll(void) {
+    const uint32_t now = micros();
+    const uint32_t gap = now - lastPoll;
+
+    if (gap > maxGap)
+        maxGap = (gap > 0xFFFF) ? 0xFFFF : uint16_t(gap);
+
+    lastPoll = now;
+    ++iterations;
+}
+
+void Diagnostics::endInterval(void) {
+    const uint32_t now     = millis();
+    const uint32_t elapsed = now - intervalStart;
+
+    if (elapsed > 0)
+        pollRate = uint16_t((uint32_t(iterations) * 1000UL) / elapsed);
+    pollGap = maxGap;
+
+    intervalStart = now;
+    iterations    = 0;
+    maxGap        = 0;
+
+    scanStack();
+}
+
+void Diagnostics::scanStack(void) {
+    // First byte above the heap the stack ever wrote to, roughly 4 cycles per free byte
+    const uint8_t *p     = (__brkval != nullptr) ? __brkval : &__heap_start;
+    const uint8_t *start = p;
+    while ((p < (uint8_t *) RAMEND) && (*p == STACK_PAINT))
+        ++p;
+
+    stackFree = uint16_t(p - start);
+}
+
+void Diagnostics::sample(const uint16_t raw, const uint16_t filtered, const uint8_t length) {
+    lastRaw      = raw;
+    lastFiltered = filtered;
+    filterLength = length;
+    if (samples < 0xFFFF)
+        ++samples;
+}
+
+void Diagnostics::setLogDropped(const uint16_t dropped) {
+    logDropped = dropped;
+}
+
+void Diagnostics::setWatchdog(const uint8_t stuck, const uint16_t resets) {
+    stuckStage     = stuck;
+    watchdogResets = resets;
+}
+
+void Diagnostics::useOptibootCause(void) {
+    if (resetCause == 0)
+        resetCause = bootCause;
+}
+
+uint8_t Diagnostics::getResetCause(void) {
+    return resetCause;
+}
+
+uint16_t Diagnostics::getStackFree(void) {
+    return stackFree;
+}
+
+void Diagnostics::fill(const uint8_t selector, uint8_t * const data) {
+    const DS2438New::Stats &stats = device->getStats();
+
+    switch (selector) {
+        case POLL:
+            put16(&data[0], pollRate);
+            put16(&data[2], pollGap);
+            put16(&data[4], stats.slaveErrors);
+            data[6] = (logDropped > 0xFF) ? 0xFF : uint8_t(logDropped);
+            break;
+
+        case DUTY_TIME:
+            memcpy(data, stats.dutyTime, DS2438New::STATS_BUCKETS);
+            break;
+
+        case COMMANDS:
+            memcpy(data, stats.commands, DS2438New::STATS_COMMANDS);
+            break;
+
+        case HEALTH:
+        {
+            const uint32_t uptime = millis() / 1000;
+            put16(&data[0], stackFree);
+            data[2] = resetCause;
+            put16(&data[3], uint16_t(uptime & 0xFFFF));
+            put16(&data[5], uint16_t(uptime >> 16));
+            break;
+        }
+
+        case FILTER:
+            put16(&data[0], lastRaw);
+            put16(&data[2], lastFiltered);
+            data[4] = filterLength;
+            put16(&data[5], samples);
+            break;
+
+        case WATCHDOG:
+            data[0] = stuckStage;
+            put16(&data[1], watchdogResets);
+            data[3] = resetCause;
+            break;
+
+        default:
+            break;
+    }
+}
@@ -0,0 +1,43 @@
+// Node diagnostics published through the DS2438 diagnostics page
+// write a selector to page 6 byte 0, then Recall Memory + Read Scratchpad page 6 to read bytes 1-7.
+// Multi byte values are LSB first.
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <Arduino.h>
+#include "DS2438New.h"
+
+class Diagnostics {
+  public:
+
+    enum Selector : uint8_t {
+        POLL      = 0,  // hub.poll() calls/s (2), max gap between calls in us (2), unknown commands (2), log bytes dropped (1)
+        DUTY_TIME = 1,  // duty() service time histogram: <128us, <256us, ... <4ms, longer
+        COMMANDS  = 2,  // command counts: 0xBE, 0xBA, 0x4E, 0x48, 0xB8, 0x44, 0xB4
+        HEALTH    = 3,  // stack never used in bytes (2), MCUSR at reset (1), uptime in s (4)
+        FILTER    = 4,  // last raw sample (2), filter output (2), filter length (1), samples since boot (2)
+        WATCHDOG  = 5,  // stage stuck in at the last watchdog reset (1), watchdog resets since power-on (2), MCUSR (1)
+    };
+
+    static void attach(DS2438New &device);
+
+    // Poll loop instrumentation, keep these cheap
+    static void poll(void);         // right before every hub.poll()
+    static void endInterval(void);  // once per reading interval, publishes the counters
+
+    static void sample(uint16_t raw, uint16_t filtered, uint8_t length);
+    static void setLogDropped(uint16_t dropped);
+    static void setWatchdog(uint8_t stuckStage, uint16_t resets);  // see Watchdog.h
+
+    static void     useOptibootCause(void); // take the cause Optiboot hands over when it cleared MCUSR
+    static uint8_t  getResetCause(void);   // MCUSR as it was at reset, 0 if unknown: treat as a cold start
+    static uint16_t getStackFree(void);    // bytes between heap and the deepest stack so far
+
+  private:
+
+    static void scanStack(void);
+    static void fill(uint8_t selector, uint8_t *data);
+};
+
+#endif
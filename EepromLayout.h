@@ -0,0 +1,18 @@
+// EEPROM addresses used by the node, ATmega328P has 1024 bytes
+
+#ifndef EEPROMLAYOUT_H
+#define EEPROMLAYOUT_H
+
+#include <Arduino.h>
+
+namespace EepromLayout {
+    constexpr uint16_t ADDRESS        { 0 };   // 1-Wire address record, see Address.cpp
+    constexpr uint8_t  ADDRESS_SIZE   { 8 };
+    constexpr uint16_t BASELINE       { 16 };  // baseline ring, see Baseline.cpp
+    constexpr uint8_t  BASELINE_SLOTS { 16 };
+    constexpr uint8_t  BASELINE_SLOT  { 4 };
+    constexpr uint16_t CONFIG         { 80 };  // configuration record, see Config.h
+    constexpr uint8_t  CONFIG_SIZE    { 9 };
+}
+
+#endif
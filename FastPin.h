@@ -0,0 +1,41 @@
+// Compile time GPIO for ATmega328P (Uno, Nano, Pro Mini)
+// pin number is a template parameter, so every access compiles to a single sbi/cbi/sbis
+// instead of the pin table lookups digitalWrite() does on every call.
+
+#ifndef FASTPIN_H
+#define FASTPIN_H
+
+#include <Arduino.h>
+
+template<uint8_t PIN>
+class FastPin {
+    static_assert(PIN < 20, "Only Arduino pins 0-19 (PORTD, PORTB, PORTC) are mapped");
+
+  private:
+
+    static constexpr uint8_t mask { uint8_t(_BV((PIN < 8) ? PIN : (PIN < 14) ? (PIN - 8) : (PIN - 14))) };
+
+    static volatile uint8_t & port(void) { return (PIN < 8) ? PORTD : (PIN < 14) ? PORTB : PORTC; }
+    static volatile uint8_t & ddr(void)  { return (PIN < 8) ? DDRD  : (PIN < 14) ? DDRB  : DDRC;  }
+    static volatile uint8_t & pin(void)  { return (PIN < 8) ? PIND  : (PIN < 14) ? PINB  : PINC;  }
+
+  public:
+
+    static void output(void) { ddr() |= mask; }
+    static void input(void)  { ddr() &= ~mask; }
+
+    static void high(void)   { port() |= mask; }
+    static void low(void)    { port() &= ~mask; }
+    static void toggle(void) { pin() = mask; }   // writing PINx toggles PORTx
+
+    static void write(const bool value) {
+        if (value)
+            high();
+        else
+            low();
+    }
+
+    static bool read(void) { return (pin() & mask) != 0; }
+};
+
+#endif
@@ -0,0 +1,59 @@
+#include "Heater.h"
+
+Heater::Heater(const uint8_t pin, const uint32_t onTime, const uint32_t offTime, const uint32_t warmup, const uint8_t duty)
+    : pin(pin), onTime(onTime), offTime(offTime), warmup(min(warmup, onTime)), duty(duty),
+      heating(false), phaseStart(0), needed(0), cycles(0) {
+}
+
+void Heater::begin(const uint32_t heated) {
+    pinMode(pin, OUTPUT);
+
+    switchOn(millis());
+    needed = (heated >= warmup) ? 0 : warmup - heated;
+}
+
+void Heater::update(void) {
+    const uint32_t now = millis();
+
+    if (heating && (now - phaseStart >= onTime)) {
+        switchOff(now);
+        cycles++;
+    } else if (!heating && (now - phaseStart >= offTime)) {
+        switchOn(now);
+    }
+}
+
+void Heater::switchOn(const uint32_t now) {
+    // The element cools roughly as long as it was off, so a short break needs less warm-up
+    const uint32_t off = now - phaseStart;
+    needed = (off >= warmup) ? warmup : off;
+
+    heating    = true;
+    phaseStart = now;
+    if (duty == 255)
+        digitalWrite(pin, HIGH);
+    else
+        analogWrite(pin, duty);
+}
+
+void Heater::switchOff(const uint32_t now) {
+    heating    = false;
+    phaseStart = now;
+    digitalWrite(pin, LOW);
+}
+
+bool Heater::isHeating(void) const {
+    return heating;
+}
+
+bool Heater::isStable(void) const {
+    return heating && (millis() - phaseStart >= needed);
+}
+
+uint32_t Heater::getHeated(void) const {
+    return heating ? (warmup - needed) + (millis() - phaseStart) : 0;
+}
+
+uint16_t Heater::getCycles(void) const {
+    return cycles;
+}
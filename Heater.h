@@ -0,0 +1,43 @@
+// MQ135 heater duty cycling through a logic level MOSFET
+// the heater is on for onTime, then off for offTime. Readings are only valid in the stable part of
+// the on phase, once the element has been heated for warmup again. The warm-up is tracked per cycle,
+// a short off phase (element still warm) gets a proportionally shorter warm-up.
+// With duty < 255 the on phase is PWM (analogWrite), use pin 9 or 10 then: Timer0 drives millis()
+// and the status LED, Timer2's pin 11 is the 1-Wire pin.
+
+#ifndef HEATER_H
+#define HEATER_H
+
+#include <Arduino.h>
+
+class Heater {
+  private:
+
+    const uint8_t  pin;
+    const uint32_t onTime;     // ms
+    const uint32_t offTime;    // ms
+    const uint32_t warmup;     // ms of heating needed after a full cool down
+    const uint8_t  duty;       // 255: plain on/off
+
+    bool           heating;
+    uint32_t       phaseStart; // millis() the current phase started
+    uint32_t       needed;     // warm-up of the current cycle
+    uint16_t       cycles;
+
+    void           switchOn(uint32_t now);
+    void           switchOff(uint32_t now);
+
+  public:
+
+    Heater(uint8_t pin, uint32_t onTime, uint32_t offTime, uint32_t warmup, uint8_t duty = 255);
+
+    void     begin(uint32_t heated = 0); // starts heating, heated: ms the element is already warm for
+    void     update(void);          // once per reading interval, or more often
+
+    bool     isHeating(void) const;
+    bool     isStable(void) const;  // warmed up, sample now
+    uint32_t getHeated(void) const; // ms heated in the current cycle incl. warm-up credit, 0 while off
+    uint16_t getCycles(void) const; // completed on phases, wrapping
+};
+
+#endif
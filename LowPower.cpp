@@ -0,0 +1,40 @@
+#include "LowPower.h"
+#include <avr/sleep.h>
+
+LowPower::LowPower(const uint8_t pin) : pin(pin), pinInput(nullptr), pinMask(0), sleepTime(0) {
+}
+
+void LowPower::begin(void) {
+    pinInput = portInputRegister(digitalPinToPort(pin));
+    pinMask  = digitalPinToBitMask(pin);
+
+    *digitalPinToPCMSK(pin) |= _BV(digitalPinToPCMSKbit(pin));
+    PCIFR  = _BV(digitalPinToPCICRbit(pin));
+    PCICR |= _BV(digitalPinToPCICRbit(pin));
+}
+
+void LowPower::idle(void) {
+    const uint32_t start = micros();
+
+    noInterrupts();
+    // Bus is low: reset or a time slot in progress, let OneWireHub handle it
+    if (!(*pinInput & pinMask)) {
+        interrupts();
+        return;
+    }
+
+    // Set every time, the ADC sampler uses its own sleep mode
+    set_sleep_mode(SLEEP_MODE_IDLE);
+    sleep_enable();
+    interrupts();   // sei executes the next instruction before any interrupt, so no wake up gets lost
+    sleep_cpu();
+    sleep_disable();
+
+    sleepTime += micros() - start;
+}
+
+uint32_t LowPower::takeSleepTime(void) {
+    const uint32_t time = sleepTime;
+    sleepTime = 0;
+    return time;
+}
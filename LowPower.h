@@ -0,0 +1,39 @@
+// Idle sleep between 1-Wire activity
+// the MCU sleeps in idle mode while the bus is high, any falling edge on the bus pin wakes it
+// through a pin-change interrupt within a few cycles, so reset and presence timing is unaffected.
+// Timer0 keeps running in idle mode, so millis() stays correct and wakes us every 1.024ms anyway.
+// The pin-change vector of the bus pin's port is defined by the sketch, only in builds using sleep,
+// so libraries using the other pin-change interrupts still link.
+// Idle, not power-down: power-down needs 16K clocks (1ms) to restart the crystal, longer than a reset.
+// Timing margin: OneWireHub only takes a reset it sees low for 430us or more, the master's shortest
+// reset is 480us, so hub.poll() has to run within 50us of the falling edge. Presence (15-60us after the
+// reset) is then timed by the hub itself. The host build (extras/host, -DUSE_SLEEP -m 100) measured
+// at most 14us from the edge to hub.poll(), 16us with all features on, no reset missed in 1200. That
+// model doesn't count the CPU time of the code between wake up and poll() (Diagnostics::poll() and the
+// loop condition), a logic analyser capture on hardware is still to be done.
+
+#ifndef LOWPOWER_H
+#define LOWPOWER_H
+
+#include <Arduino.h>
+
+class LowPower {
+  private:
+
+    const uint8_t     pin;
+    volatile uint8_t *pinInput;   // PINx register of the bus pin
+    uint8_t           pinMask;
+
+    uint32_t          sleepTime;  // us spent sleeping since last takeSleepTime()
+
+  public:
+
+    explicit LowPower(uint8_t pin);
+
+    void     begin(void);           // enable the pin-change wake up
+    void     idle(void);            // sleep until the next interrupt, returns right away if the bus is busy
+
+    uint32_t takeSleepTime(void);   // us slept since the last call
+};
+
+#endif
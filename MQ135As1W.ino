@@ -14,8 +14,55 @@
     Temperature + VAD values are used to transfer ppm, max value for this setup is 5628934.50 ppm.
        Conversion formula = (((Temp + 55.0) / 180) + (VAD * 100)) * 5760
     DS2438 also returns analog measurement in VDD, Vsens measurement is always 0.
+
+    Page 1 holds a change counter in byte 0 and flags in byte 1 (bit 0: page 0 changed since last read).
+    Masters can read just these two bytes and skip reading page 0 if the counter didn't move.
+    The counter only moves when the filtered value changes by more than PUBLISH_DEADBAND (page 1, byte 2).
+
+    Page 2 configures an alarm: bytes 0-1 set threshold, bytes 2-3 clear threshold (both raw value, LSB first),
+    byte 4 bit 0 enables it. Alarm state is flag bit 1 in page 1, entering or leaving alarm also moves the counter.
+    Conditional search (0xEC) is not implemented, the ROM layer belongs to OneWireHub: masters find alarming
+    nodes by reading the first two bytes of page 1 from each of them.
+
+    With USE_PPM the node also converts the filtered value to ppm itself (MQ135 curve, see Mq135Curve.h),
+    page 3 bytes 0-1 hold the result, LSB first, saturating at 65535.
+
+    With USE_COMPENSATION the AVR internal temperature sensor is read every TEMP_INTERVAL readings and published
+    as DS2438 temperature (so Temp no longer is 0). The filtered value corrected to 20degC / 33%RH goes to
+    page 3 bytes 2-3 and is what the ppm conversion uses. VAD stays the uncorrected filtered value.
+
+    With USE_VCC the supply voltage is measured every VCC_INTERVAL readings from the internal bandgap and
+    published in VDD (master selects it with the AD bit in page 0 and Convert V, like on the real DS2438).
+    USE_VCC_CORRECTION additionally scales VAD to what it would be at VCC_NOMINAL, for setups where the
+    sensor output doesn't follow the ADC reference (e.g. sensor supplied separately from the Arduino).
+
+    With USE_HEATER the MQ135 heater is switched through a MOSFET on PIN_HEATER: on for HEATER_ON_TIME, off for
+    HEATER_OFF_TIME. Readings are only taken once the heater ran HEATER_WARMUP in the current cycle, in between
+    the published values hold. The LED shows the warm-up pattern while no readings are taken.
+
+    With USE_WARM_RESTART the filter, the baseline and how long the sensor has been heated survive resets that
+    don't cut the power (watchdog, reset button, brown-out), so INIT_DELAY is skipped or shortened after them.
+
+    With USE_WATCHDOG the hardware watchdog resets the node if the loop stops making progress. Diagnostics
+    selector 5 shows where it was stuck and how often that happened since power-on.
+
+    With USE_BASELINE the node tracks the clean air level over days (kept in EEPROM across power cycles):
+    page 3 bytes 4-5 hold value / baseline (256 = clean air), bytes 6-7 the baseline itself.
+
+    Page 6 is a diagnostics window: write a selector to byte 0 (bit 7 clears the counters), bytes 1-7 then hold
+    poll loop timing, duty() service times, command counts, stack headroom and reset cause or filter state,
+    see Diagnostics.h.
+
+    Page 7 holds the node's configuration (reading interval, filter length, init delay, LED), see Config.h.
+    The defines below are only the defaults: write page 7 and send Copy Scratchpad (0x48) for page 7 to change
+    and persist them, the node applies them right away (init delay at the next boot).
+
+    Vendor command 0xBA reads several pages in one go: send a page mask byte (bit n = page n, 0 = BULK_PAGES),
+    the selected pages follow back-to-back, then an inverted CRC16 over command, mask and data (LSB first).
     
-    During first run Arduino generates it's own random 1-Wire address that is then stored in EEPROM
+    During first run Arduino generates it's own random 1-Wire address that is then stored in EEPROM.
+    With USE_ADDRESS_COMMAND masters can assign one instead with vendor command 0xD5: 6 address bytes (LSB
+    first, without family code and CRC) and their CRC8, the node answers 0xAA and uses it from the next reset.
     Make sure to define either DS18B20 or DS2438, don't use both of them at the same time!
 
     Power consumption of Arduino + MQ135 is around 0.2 A, so definitely power it with external power supply.
@@ -26,35 +73,130 @@
     Prerequisites:
       https://github.com/GeorgK/MQ135
       https://github.com/orgua/OneWireHub
-      https://github.com/sirleech/TrueRandom
 */
 /**************************************************************************/
 
 //#define DEBUG
 
+// Stream raw samples as binary frames over serial for sensor characterization, see SampleStream.h.
+// Uses the same serial port as DEBUG, so only define one of them
+//#define STREAM_SAMPLES
+#define STREAM_INTERVAL 4000  // us between samples, 250Hz
+
+#if defined(DEBUG) && defined(STREAM_SAMPLES)
+  #error "DEBUG and STREAM_SAMPLES both write to serial"
+#endif
+
 #include <EEPROM.h>
 #include "OneWireHub.h"
 #include "OneWireItem.h"
-#include <TrueRandom.h>
+#include "Address.h"
 
 // Define if to use DS2438 (other options removed in this version)
 #define USE_DS2438
 
+// The bootloader is Optiboot: it clears MCUSR and hands the reset cause over in r2. With other bootloaders
+// r2 is undefined, so the reset cause is only known if MCUSR survived (unknown counts as a power-on)
+//#define USE_OPTIBOOT
+
 // Pin definition
 #define PIN_A_MQ135   A0  // Pin for analog input from MQ135
 #define PIN_ONE_WIRE  11  // 1-Wire pin
 
+// Overdrive speed (Overdrive Skip/Match ROM, 0x3C/0x69). Slot timing is done by OneWireHub, so overdrive
+// has to be switched on in the library too (OVERDRIVE_ENABLE in OneWireHub_config.h), this just makes sure it is.
+// Not validated: reset/presence and slot timing at overdrive speed haven't been checked on hardware, and the
+// host build doesn't model it. An overdrive reset (70us, the hub needs 48us of it) leaves ~20us to reach
+// hub.poll(), barely above the 14-16us the host build measured without code time (see LowPower.h). Leave it off.
+//#define USE_OVERDRIVE
+
+// Sleep between bus activity, the pin-change interrupt on PIN_ONE_WIRE wakes the MCU for a reset, see LowPower.h
+//#define USE_SLEEP
+
+#ifdef USE_OVERDRIVE
+  static_assert(OVERDRIVE_ENABLE, "USE_OVERDRIVE needs OVERDRIVE_ENABLE set in OneWireHub_config.h");
+#endif
+
+// Sample the MQ135 in ADC noise reduction sleep. Samples are much less noisy, so the filter can be shorter
+//#define USE_ADC_SLEEP
+
+// ADC clock for the MQ135 channel. DIV_128 gives full 10 bit accuracy at 16MHz, DIV_32 converts 4x faster
+// with ~8 good bits, which is enough when the moving average is long. Internal channels always use DIV_128
+#define ADC_PRESCALER AdcScheduler::DIV_128
+
+// Convert to ppm on the node and publish it in page 3, calibrate RZERO in Mq135Curve.h first
+//#define USE_PPM
+
+// Compensate temperature (and humidity, if a sensor feeds Compensation::setHumidity()) on the node
+//#define USE_COMPENSATION
+#define TEMP_INTERVAL 60  // readings between two temperature measurements
+
+// Measure VCC through the bandgap and publish it in VDD, optionally correct VAD to the nominal supply
+//#define USE_VCC
+//#define USE_VCC_CORRECTION
+#define VCC_INTERVAL 10    // readings between two VCC measurements
+#define VCC_NOMINAL  5000  // mV
+
+#if defined(USE_VCC_CORRECTION) && !defined(USE_VCC)
+  #error "USE_VCC_CORRECTION needs USE_VCC"
+#endif
+
+// Duty cycle the MQ135 heater (the bulk of the power draw), the heater goes through a logic level MOSFET
+//#define USE_HEATER
+#define PIN_HEATER      9       // use 9 or 10 with HEATER_DUTY below 255, see Heater.h
+#define HEATER_ON_TIME  120000  // ms
+#define HEATER_OFF_TIME 120000  // ms
+#define HEATER_WARMUP   90000   // ms of heating before readings are taken, after a full cool down
+#define HEATER_DUTY     255     // 255 = full power while on, lower values PWM the heater
+
+#if defined(USE_HEATER) && (HEATER_DUTY < 255)
+  static_assert(PIN_HEATER == 9 || PIN_HEATER == 10, "PWM heater needs a Timer1 pin");
+#endif
+
+// Track the long-term baseline on the node, so recalibration is automatic
+//#define USE_BASELINE
+
+// Keep the filter state over resets that don't cut the power and skip the warm-up after them
+//#define USE_WARM_RESTART
+
+#if defined(USE_WARM_RESTART) && !defined(USE_DS2438)
+  #error "USE_WARM_RESTART needs the reset cause from Diagnostics"
+#endif
+
+// Reset through the watchdog when the loop stops making progress, see Watchdog.h
+//#define USE_WATCHDOG
+#define WATCHDOG_TICK 4000  // ms without a completed reading interval before the watchdog fires
+
+#if defined(USE_WATCHDOG) && !defined(USE_DS2438)
+  #error "USE_WATCHDOG needs the reset cause from Diagnostics"
+#endif
+
+// Defaults of the runtime configuration, see Config.h
+
 // Reading interval
 // Note that OneWire data polling causes some delays, so don't expect exact timing defined in here.
 // Better not to touch it
 #define READING_INTERVAL 1000
 
 // Keep a moving average over this many readings
-#define MA_READINGS 48
+#ifdef USE_ADC_SLEEP
+  #define MA_READINGS 16
+#else
+  #define MA_READINGS 48
+#endif
 
-int ma_total = 0;
-int ma_output = 0;
-int ma_init = false;
+// Filtered value has to move by more than this before masters are told about a change
+#define PUBLISH_DEADBAND 1
+
+// Let the master assign the 1-Wire address (vendor command 0xD5), e.g. from a fleet list to avoid collisions
+//#define USE_ADDRESS_COMMAND
+
+// Pages returned by vendor command 0xBA when the master sends mask 0: page 0 (values) and page 1 (status)
+#define BULK_PAGES 0x03
+
+// Default alarm thresholds (raw value), can be changed over the bus. Uncomment to start with alarm enabled
+//#define ALARM_SET   600
+//#define ALARM_CLEAR 550
 
 // Init delay, MQ135 needs some time to heat up, suggest to use delay 3 minutes => 3 * 60 * 1000
 // If you don't find this useful, comment next line out
@@ -63,46 +205,184 @@ int ma_init = false;
 #else
   #define INIT_DELAY 180000
 #endif
+#ifndef INIT_DELAY
+  #define INIT_DELAY 0
+#endif
+
+// Runtime configuration, the defines above are its defaults
+#include "Config.h"
+static_assert((READING_INTERVAL >= Config::MIN_INTERVAL) && (READING_INTERVAL <= Config::MAX_INTERVAL), "READING_INTERVAL is out of range, see Config.h");
+#ifdef USE_WATCHDOG
+  // The longest interval a master can set has to tick the watchdog in time
+  static_assert(WATCHDOG_TICK > Config::MAX_INTERVAL, "WATCHDOG_TICK has to be above Config::MAX_INTERVAL");
+#endif
+
+// Status LED, patterns are played from a timer interrupt
+#include "StatusLed.h"
+
+// Show the bus error pattern if no master talked to us for this long
+#define BUS_TIMEOUT 300000
+
+// Debug output goes through a ring buffer and never blocks
+#if defined(DEBUG) || defined(STREAM_SAMPLES)
+  #include "DebugLog.h"
+  DebugLog Log;
+#endif
+
+#ifdef STREAM_SAMPLES
+  #include "SampleStream.h"
+#endif
 
 // Init Hub
 OneWireHub hub = OneWireHub(PIN_ONE_WIRE);
 
+// All conversions go through the scheduler, so they are spread over the polling time
+#include "AdcSampler.h"
+#include "AdcScheduler.h"
+uint8_t adcMq135;
+
+#ifdef USE_PPM
+  #include "Mq135Curve.h"
+#endif
+
+#ifdef USE_BASELINE
+  #include "Baseline.h"
+#endif
+
+#ifdef USE_COMPENSATION
+  #include "Compensation.h"
+  uint8_t adcTemperature;
+  uint8_t temperatureCount = TEMP_INTERVAL;
+#endif
+
+#ifdef USE_VCC
+  uint8_t  adcVcc;
+  uint8_t  vccCount = VCC_INTERVAL;
+  uint16_t vcc = VCC_NOMINAL;
+#endif
+
+#ifdef STREAM_SAMPLES
+  uint8_t adcStream;
+#endif
+
+#ifdef USE_HEATER
+  #include "Heater.h"
+  Heater heater = Heater(PIN_HEATER, HEATER_ON_TIME, HEATER_OFF_TIME, HEATER_WARMUP, HEATER_DUTY);
+#endif
+
+#ifdef USE_WARM_RESTART
+  #include "WarmRestart.h"
+  #ifndef USE_HEATER
+    uint32_t heated;      // ms the sensor has been heated, carried over warm restarts
+    uint32_t heatedCheck;
+  #endif
+#endif
+
+#ifdef USE_WATCHDOG
+  #include "Watchdog.h"
+  #define STAGE(s) Watchdog::stage(Watchdog::s)
+#else
+  #define STAGE(s)
+#endif
+
+// Both sleep modes need the pin-change wake up, a reset pulse must not wait for the end of a conversion
+#if defined(USE_SLEEP) || defined(USE_ADC_SLEEP)
+  #include "LowPower.h"
+  LowPower lowPower = LowPower(PIN_ONE_WIRE);
+
+  // Only needed to wake the MCU, OneWireHub does the real work in poll(). PIN_ONE_WIRE has to be a plain number here
+  #if PIN_ONE_WIRE <= 7
+    EMPTY_INTERRUPT(PCINT2_vect);
+    static_assert(digitalPinToPCICRbit(PIN_ONE_WIRE) == PCIE2, "Wake-up vector doesn't match PIN_ONE_WIRE");
+  #elif PIN_ONE_WIRE <= 13
+    EMPTY_INTERRUPT(PCINT0_vect);
+    static_assert(digitalPinToPCICRbit(PIN_ONE_WIRE) == PCIE0, "Wake-up vector doesn't match PIN_ONE_WIRE");
+  #else
+    EMPTY_INTERRUPT(PCINT1_vect);
+    static_assert(digitalPinToPCICRbit(PIN_ONE_WIRE) == PCIE1, "Wake-up vector doesn't match PIN_ONE_WIRE");
+  #endif
+#endif
+
 // DS2438
 #ifdef USE_DS2438
   #include "DS2438New.h"
+  #include "Diagnostics.h"
   DS2438New *ds2438;
+  static_assert(Config::SIZE == DS2438New::CONFIG_SIZE, "Configuration has to fill the DS2438 page");
 #endif
 
 // 1W address
 uint8_t addr[7] = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 };
 
 // Function definition
-void dumpAddress(char *prefix, OneWireItem *item, char *postfix);
+#ifdef DEBUG
+  void dumpAddress(const char *prefix, OneWireItem *item, const char *postfix);
+#endif
 
 // Setup call
 void setup() {
     // Use serial only for debug, once deploying solution comment out Serial.begin line
-    #ifdef DEBUG    
+    #if defined(DEBUG) || defined(STREAM_SAMPLES)
       Serial.begin(115200);
-      Serial.println("OneWire-Hub MQ135 sensor");
+    #endif
+    #ifdef DEBUG
+      Log.println("OneWire-Hub MQ135 sensor");
     #endif
 
-    pinMode(LED_BUILTIN, OUTPUT);
+    StatusLed::begin();
 
-    // 1W address storred in EEPROM
-    if (EEPROM.read(0) == '#') {
-        Serial.println("Reading 1W address from EEPROM");
-        for (int i = 1; i < 7; i++)
-            addr[i] = EEPROM.read(i);
-    }
-    // 1W address not set, generate random value
-    else {
-        Serial.println("Generating random 1W address");
-        for (int i = 1; i < 7; i++) {
-            addr[i] = (i != 6) ? TrueRandom.random(256): TrueRandom.random(256);
-            EEPROM.write(i, addr[i]);
-        }
-        EEPROM.write(0, '#');
+    Config::begin({ READING_INTERVAL, MA_READINGS, INIT_DELAY / 1000, 0 });
+
+    #if defined(USE_OPTIBOOT) && defined(USE_DS2438)
+      Diagnostics::useOptibootCause();
+    #endif
+
+    #ifdef USE_WARM_RESTART
+      if (WarmRestart::begin(Diagnostics::getResetCause())) {
+        #ifdef DEBUG
+          Log.println("Warm restart");
+        #endif
+      }
+    #endif
+
+    #ifdef USE_HEATER
+      #ifdef USE_WARM_RESTART
+        heater.begin(WarmRestart::get().heated);
+      #else
+        heater.begin();
+      #endif
+    #elif defined(USE_WARM_RESTART)
+      heated = WarmRestart::get().heated;
+    #endif
+
+    // ADC channels, converted in this order when several are due
+    #ifdef USE_ADC_SLEEP
+      AdcScheduler::begin(true);
+    #else
+      AdcScheduler::begin(false);
+    #endif
+    adcMq135 = AdcScheduler::add({ AdcSampler::mux(PIN_A_MQ135), ADC_PRESCALER, 0, 1, Config::get().filterLength });
+    #ifdef STREAM_SAMPLES
+      adcStream = AdcScheduler::add({ AdcSampler::mux(PIN_A_MQ135), ADC_PRESCALER, 0, 1, 1 });
+    #endif
+    #ifdef USE_VCC
+      // AVcc stays the reference, the first conversion covers the ~70us bandgap start-up
+      adcVcc = AdcScheduler::add({ AdcSampler::MUX_BANDGAP, AdcScheduler::DIV_128, 0, 1, 4 });
+    #endif
+    #ifdef USE_COMPENSATION
+      // Switching to the 1.1V reference has to wait for the AREF capacitor
+      adcTemperature = AdcScheduler::add({ AdcSampler::MUX_TEMPERATURE, AdcScheduler::DIV_128, 20, 1, 1 });
+    #endif
+    #ifdef USE_WARM_RESTART
+      if (WarmRestart::isWarm() && (WarmRestart::get().filterTotal != 0))
+        AdcScheduler::restore(adcMq135, WarmRestart::get().filterOutput, WarmRestart::get().filterTotal);
+    #endif
+
+    // 1W address stored in EEPROM, generated on the first run
+    if (Address::begin(&addr[1])) {
+        #ifdef DEBUG
+          Log.println("Generated random 1W address");
+        #endif
     }
 
     // Init DS2438
@@ -111,9 +391,28 @@ void setup() {
       ds2438->setCurrent(0);
       ds2438->setVDDVoltage(0);
       ds2438->setTemperature((int8_t) 0);
+      ds2438->setDeadband(PUBLISH_DEADBAND);
+      ds2438->setBulkPages(BULK_PAGES);
+      #ifdef USE_ADDRESS_COMMAND
+        ds2438->enableAddressCommand(true);
+      #endif
+      uint8_t config[Config::SIZE];
+      Config::toPage(config);
+      ds2438->setConfig(config);
+      #ifdef ALARM_SET
+        ds2438->setAlarmThresholds(ALARM_SET, ALARM_CLEAR);
+      #endif
+      Diagnostics::attach(*ds2438);
       hub.attach(*ds2438);
     #endif
 
+    #ifdef USE_BASELINE
+      Baseline::begin();
+      #ifdef USE_WARM_RESTART
+        Baseline::setState(WarmRestart::get().baseline);  // newer than the last EEPROM slot
+      #endif
+    #endif
+
     // Log addresses
     #ifdef USE_DS2438
     #ifdef DEBUG
@@ -121,67 +420,248 @@ void setup() {
     #endif
     #endif
 
-    #ifdef INIT_DELAY
-      Serial.print("Init delay...");
-      unsigned long delayEnd= millis() + INIT_DELAY;
+    #ifdef USE_WATCHDOG
+      Watchdog::begin(Diagnostics::getResetCause(), WATCHDOG_TICK);
+      Diagnostics::setWatchdog(Watchdog::getStuckStage(), Watchdog::getResets());
+    #endif
+
+    const uint32_t initDelay = uint32_t(Config::get().initDelay) * 1000;
+    if (initDelay > 0) {
+      #ifdef DEBUG
+        Log.print("Init delay...");
+      #endif
+      StatusLed::set(StatusLed::Pattern::WARMUP);
+      #ifdef USE_WARM_RESTART
+        unsigned long delayEnd= millis() + WarmRestart::remaining(initDelay);
+      #else
+        unsigned long delayEnd= millis() + initDelay;
+      #endif
+      STAGE(WARMUP);
       while (delayEnd > millis()) {
-        digitalWrite(LED_BUILTIN, ((millis() % 100) < 50) ? 1 : 0);
+        #ifdef USE_WATCHDOG
+          Watchdog::tick();
+          Watchdog::kick();
+        #endif
+        #ifdef USE_HEATER
+          heater.update();
+        #endif
+        #if defined(DEBUG) || defined(STREAM_SAMPLES)
+          Log.pump();
+        #endif
       }
-      Serial.println("done");
+      #ifdef DEBUG
+        Log.println("done");
+      #endif
+    }
+
+    #if defined(USE_SLEEP) || defined(USE_ADC_SLEEP)
+      lowPower.begin();
     #endif
 }
 
 // Loop call
 int samples = 0;
 void loop() {
-    // Read value from sensor
-    int mq135 = analogRead(PIN_A_MQ135);
-
-    // Modify moving average accordingly
-    if (!ma_init) {
-      // First reading, just use the one we read
-      ma_output = mq135;
-      ma_total = ma_output * MA_READINGS;
-      ma_init = true;
-    } else {
-      // Subtract one reading from total to give (MA_READINGS - 1) values totalled up.
-      ma_total -= ma_output;
-      // Add the value we just read
-      ma_total += mq135;
-      // And divide the total by readings to get the current average
-      ma_output = ma_total / MA_READINGS;
-    }
+    STAGE(RESULTS);
 
-    #ifdef DEBUG
-      Serial.print("MA value: "); Serial.print(ma_output);
-      Serial.print(" Last raw value: "); Serial.println(mq135);
+    // Address assigned by the master, used from the next reset on
+    #ifdef USE_ADDRESS_COMMAND
+      uint8_t assigned[Address::SIZE];
+      if (ds2438->takeAddressRequest(assigned)) {
+        Address::save(assigned);
+        #ifdef DEBUG
+          Log.println("1W address assigned, used after the next reset");
+        #endif
+      }
+    #endif
+
+    // Configuration committed by the master
+    #ifdef USE_DS2438
+      if (ds2438->takeCopyRequests() & _BV(DS2438New::CONFIG_PAGE)) {
+        uint8_t config[Config::SIZE];
+        ds2438->getConfig(config);
+        if (Config::set(config)) {
+          if (Config::get().filterLength != AdcScheduler::length(adcMq135))
+            AdcScheduler::setLength(adcMq135, Config::get().filterLength);
+        }
+        // Shows what is in effect, also when the page was rejected
+        Config::toPage(config);
+        ds2438->setConfig(config);
+      }
     #endif
 
+    // Results of the conversions done while polling in the previous interval
+    #ifdef USE_VCC
+      if (AdcScheduler::take(adcVcc)) {
+        vcc = AdcSampler::toVcc(AdcScheduler::value(adcVcc));
+        #ifdef USE_DS2438
+          ds2438->setVDDVoltage(vcc / 10);
+        #endif
+      }
+    #endif
+
+    #ifdef USE_COMPENSATION
+      if (AdcScheduler::take(adcTemperature)) {
+        Compensation::setTemperature(Compensation::toDegC(AdcScheduler::value(adcTemperature)));
+        ds2438->setTemperature(Compensation::getTemperature());
+      }
+    #endif
+
+    if (AdcScheduler::take(adcMq135)) {
+        const uint16_t mq135     = AdcScheduler::raw(adcMq135);
+        const uint16_t ma_output = AdcScheduler::value(adcMq135);
+
+        #ifdef DEBUG
+          Log.print("MA value: "); Log.print(ma_output);
+          Log.print(" Last raw value: "); Log.println(mq135);
+        #endif
+
+        #ifdef USE_DS2438
+          Diagnostics::sample(mq135, ma_output, AdcScheduler::length(adcMq135));
+
+          // Optional processing stages, each works on the output of the previous one
+          uint16_t value = ma_output;
+          #ifdef USE_VCC_CORRECTION
+            value = min(1023UL, (uint32_t(value) * vcc) / VCC_NOMINAL);
+          #endif
+          ds2438->setVADVoltage(value);
+          #ifdef USE_COMPENSATION
+            value = Compensation::apply(value);
+            ds2438->setCompensated(value);
+          #endif
+          #ifdef USE_PPM
+            ds2438->setPpm(Mq135Curve::ppm(value));
+          #endif
+          #ifdef USE_BASELINE
+            Baseline::update(value);
+            ds2438->setBaseline(Baseline::get(), Baseline::normalize(value));
+          #endif
+          (void) value;
+        #endif
+    }
+
     #ifdef USE_DS2438
-      ds2438->setVADVoltage(ma_output);
+      if (Config::get().flags & Config::FLAG_LED_OFF)
+        StatusLed::set(StatusLed::Pattern::OFF);
+      else if (ds2438->getAlarm())
+        StatusLed::set(StatusLed::Pattern::ALARM);
+      else if (millis() - ds2438->getLastCommandTime() > BUS_TIMEOUT)
+        StatusLed::set(StatusLed::Pattern::BUS_ERROR);
+      #ifdef USE_HEATER
+      else if (!heater.isStable())
+        StatusLed::set(StatusLed::Pattern::WARMUP);
+      #endif
+      else
+        StatusLed::set(StatusLed::Pattern::NORMAL);
+    #endif
+
+    // Keep the state for a warm restart
+    #ifdef USE_WARM_RESTART
+      WarmRestart::State state;
+      state.filterOutput = AdcScheduler::value(adcMq135);
+      state.filterTotal  = AdcScheduler::getTotal(adcMq135);
+      #ifdef USE_BASELINE
+        state.baseline = Baseline::getState();
+      #else
+        state.baseline = 0;
+      #endif
+      #ifdef USE_HEATER
+        state.heated = heater.getHeated();
+      #else
+        const uint32_t now = millis();
+        if (heated < 0x80000000UL)  // saturate, only has to cover the warm-up
+          heated += now - heatedCheck;
+        heatedCheck = now;
+        state.heated = heated;
+      #endif
+      WarmRestart::save(state);
+    #endif
+
+    // Conversions for this interval, they run from the poll loop
+    #ifdef USE_HEATER
+      heater.update();
+      if (heater.isStable())
+        AdcScheduler::request(adcMq135);
+    #else
+      AdcScheduler::request(adcMq135);
+    #endif
+    #ifdef USE_VCC
+      if (++vccCount >= VCC_INTERVAL) {
+        AdcScheduler::request(adcVcc);
+        vccCount = 0;
+      }
+    #endif
+    #ifdef USE_COMPENSATION
+      if (++temperatureCount >= TEMP_INTERVAL) {
+        AdcScheduler::request(adcTemperature);
+        temperatureCount = 0;
+      }
+    #endif
+
+    #ifdef USE_WATCHDOG
+      Watchdog::tick();
     #endif
 
     // Polling one wire data
-    unsigned long stopPolling = millis() + READING_INTERVAL;
-    // Flash for 10ms
-    unsigned long longFlash = millis() + 10;
-    // Only Flash once every 30s
-    boolean flash = (millis() % 30000) < READING_INTERVAL ? 1 : 0;
+    #if defined(USE_SLEEP) && defined(DEBUG)
+      unsigned long startPolling = micros();
+    #endif
+    unsigned long stopPolling = millis() + Config::get().readingInterval;
+
     while (stopPolling > millis()) {
-        digitalWrite(LED_BUILTIN, ((millis() < longFlash) && flash) ? 1 : 0);
+        #ifdef USE_DS2438
+          Diagnostics::poll();
+        #endif
+        STAGE(HUB_POLL);
         hub.poll();
+        #ifdef USE_WATCHDOG
+          Watchdog::kick();
+        #endif
+        STAGE(ADC_SERVICE);
+        AdcScheduler::service();
+        STAGE(LOG);
+        #ifdef STREAM_SAMPLES
+          if (SampleStream::due(STREAM_INTERVAL))
+            AdcScheduler::request(adcStream);
+          if (AdcScheduler::take(adcStream))
+            SampleStream::send(Log, AdcScheduler::raw(adcStream), AdcScheduler::value(adcMq135));
+        #endif
+        #if defined(DEBUG) || defined(STREAM_SAMPLES)
+          Log.pump();
+        #endif
+        STAGE(SLEEP);
+        #ifdef USE_SLEEP
+          lowPower.idle();
+        #endif
     }
+
+    STAGE(END_INTERVAL);
+    #ifdef USE_DS2438
+      #ifdef DEBUG
+        Diagnostics::setLogDropped(Log.getDropped());
+      #endif
+      Diagnostics::endInterval();
+    #endif
+
+    // Report how many CPU cycles per second were spent awake
+    #if defined(USE_SLEEP) && defined(DEBUG)
+      unsigned long polled = micros() - startPolling;
+      unsigned long active = polled - lowPower.takeSleepTime();
+      Log.print("Active cycles/s: "); Log.println((active * (F_CPU / 1000000UL)) / (polled / 1000UL) * 1000UL);
+    #endif
 }
 
 // Prints the device address to console
-void dumpAddress(char *prefix, OneWireItem *item, char *postfix) {
-  Serial.print(prefix);
+#ifdef DEBUG
+void dumpAddress(const char *prefix, OneWireItem *item, const char *postfix) {
+  Log.print(prefix);
   
   for (int i = 0; i < 8; i++) {
-      Serial.print(item->ID[i] < 16 ? "0":"");
-      Serial.print(item->ID[i], HEX);
-      Serial.print((i < 7)?".":"");
+      Log.print(item->ID[i] < 16 ? "0":"");
+      Log.print(item->ID[i], HEX);
+      Log.print((i < 7)?".":"");
   }
 
-  Serial.println(postfix);
+  Log.println(postfix);
 }
+#endif
@@ -0,0 +1,74 @@
+#include "Mq135Curve.h"
+
+namespace {
+
+    // C++11 constexpr math, only ever evaluated by the compiler
+
+    constexpr double LN2 { 0.69314718055994530942 };
+
+    // ln(x) = 2 * atanh((x - 1) / (x + 1)), x reduced to [0.5, 2] first
+    constexpr double atanhSeries(const double y, const double y2, const double term, const int n) {
+        return (n > 61) ? 0.0 : term / n + atanhSeries(y, y2, term * y2, n + 2);
+    }
+
+    constexpr double ln(const double x) {
+        return (x > 2.0) ? ln(x / 2.0) + LN2
+             : (x < 0.5) ? ln(x * 2.0) - LN2
+             : 2.0 * atanhSeries((x - 1.0) / (x + 1.0), ((x - 1.0) / (x + 1.0)) * ((x - 1.0) / (x + 1.0)), (x - 1.0) / (x + 1.0), 1);
+    }
+
+    // exp(z) = exp(z / 2)^2 until |z| is small, then Taylor
+    constexpr double expTaylor(const double z, const double term, const int n) {
+        return (n > 16) ? term : term + expTaylor(z, term * z / n, n + 1);
+    }
+
+    constexpr double square(const double x) {
+        return x * x;
+    }
+
+    constexpr double exp(const double z) {
+        return ((z > 0.5) || (z < -0.5)) ? square(exp(z / 2.0)) : expTaylor(z, 1.0, 1);
+    }
+
+    constexpr uint16_t saturate(const double ppm) {
+        return (ppm >= Mq135Curve::PPM_MAX) ? Mq135Curve::PPM_MAX : uint16_t(ppm + 0.5);
+    }
+
+    constexpr uint16_t ppmAt(const uint16_t adc) {
+        return (adc == 0)     ? 0
+             : (adc >= 1023)  ? Mq135Curve::PPM_MAX
+             : saturate(Mq135Curve::PARA * exp(-Mq135Curve::PARB * ln(((1023.0 / adc) - 1.0) * Mq135Curve::RLOAD / Mq135Curve::RZERO)));
+    }
+
+    #define MQ135_POINT(i) ppmAt((i) << Mq135Curve::STEP_BITS)
+
+    constexpr uint16_t table[Mq135Curve::POINTS] PROGMEM = {
+        MQ135_POINT( 0), MQ135_POINT( 1), MQ135_POINT( 2), MQ135_POINT( 3), MQ135_POINT( 4), MQ135_POINT( 5), MQ135_POINT( 6), MQ135_POINT( 7),
+        MQ135_POINT( 8), MQ135_POINT( 9), MQ135_POINT(10), MQ135_POINT(11), MQ135_POINT(12), MQ135_POINT(13), MQ135_POINT(14), MQ135_POINT(15),
+        MQ135_POINT(16), MQ135_POINT(17), MQ135_POINT(18), MQ135_POINT(19), MQ135_POINT(20), MQ135_POINT(21), MQ135_POINT(22), MQ135_POINT(23),
+        MQ135_POINT(24), MQ135_POINT(25), MQ135_POINT(26), MQ135_POINT(27), MQ135_POINT(28), MQ135_POINT(29), MQ135_POINT(30), MQ135_POINT(31),
+        MQ135_POINT(32), MQ135_POINT(33), MQ135_POINT(34), MQ135_POINT(35), MQ135_POINT(36), MQ135_POINT(37), MQ135_POINT(38), MQ135_POINT(39),
+        MQ135_POINT(40), MQ135_POINT(41), MQ135_POINT(42), MQ135_POINT(43), MQ135_POINT(44), MQ135_POINT(45), MQ135_POINT(46), MQ135_POINT(47),
+        MQ135_POINT(48), MQ135_POINT(49), MQ135_POINT(50), MQ135_POINT(51), MQ135_POINT(52), MQ135_POINT(53), MQ135_POINT(54), MQ135_POINT(55),
+        MQ135_POINT(56), MQ135_POINT(57), MQ135_POINT(58), MQ135_POINT(59), MQ135_POINT(60), MQ135_POINT(61), MQ135_POINT(62), MQ135_POINT(63),
+        MQ135_POINT(64)
+    };
+
+    #undef MQ135_POINT
+
+    static_assert(Mq135Curve::POINTS == 65, "Table initializer has to match the step size");
+}
+
+uint16_t Mq135Curve::ppm(const uint16_t adc) {
+    const uint8_t  index = uint8_t(adc >> STEP_BITS);
+    const uint8_t  frac  = uint8_t(adc & ((1 << STEP_BITS) - 1));
+
+    if (index >= POINTS - 1)
+        return PPM_MAX;
+
+    const uint16_t y0 = pgm_read_word(&table[index]);
+    const uint16_t y1 = pgm_read_word(&table[index + 1]);
+
+    // Curve is rising, so y1 >= y0
+    return y0 + uint16_t((uint32_t(y1 - y0) * frac) >> STEP_BITS);
+}
@@ -0,0 +1,27 @@
+// MQ135 ppm conversion without floating point at run time
+// ppm = PARA * (Rs / R0) ^ -PARB, with Rs taken from the ADC value and the load resistor, as in
+// https://github.com/GeorgK/MQ135. The curve is sampled into a flash table at compile time and
+// interpolated linearly, a conversion costs one multiply and two flash reads.
+
+#ifndef MQ135CURVE_H
+#define MQ135CURVE_H
+
+#include <Arduino.h>
+
+class Mq135Curve {
+  public:
+
+    // Sensor constants, RZERO is the resistance in clean air and has to be calibrated per sensor
+    static constexpr double RLOAD { 10.0 };         // kOhm, load resistor on the board
+    static constexpr double RZERO { 76.63 };        // kOhm
+    static constexpr double PARA  { 116.6020682 };
+    static constexpr double PARB  { 2.769034857 };
+
+    static constexpr uint8_t  STEP_BITS { 4 };      // table point every 16 ADC counts
+    static constexpr uint8_t  POINTS    { (1024 >> STEP_BITS) + 1 };
+    static constexpr uint16_t PPM_MAX   { 0xFFFF }; // saturates here
+
+    static uint16_t ppm(uint16_t adc);              // 10 bit ADC value, e.g. the filter output
+};
+
+#endif
@@ -0,0 +1,40 @@
+#include "SampleStream.h"
+#include "OneWireItem.h"
+
+namespace {
+    uint8_t  sequence;
+    uint32_t lastDue;
+    uint32_t lastFrame;
+}
+
+bool SampleStream::due(const uint16_t interval_us) {
+    const uint32_t now = micros();
+    if (now - lastDue < interval_us)
+        return false;
+
+    lastDue = now;
+    return true;
+}
+
+void SampleStream::send(DebugLog &out, const uint16_t raw, const uint16_t filtered) {
+    const uint32_t now   = micros();
+    const uint32_t delta = now - lastFrame;
+
+    uint8_t frame[FRAME_SIZE];
+    frame[0] = SYNC0;
+    frame[1] = SYNC1;
+    frame[2] = sequence++;
+    frame[3] = uint8_t(delta > 0xFFFF ? 0xFF : delta & 0xFF);
+    frame[4] = uint8_t(delta > 0xFFFF ? 0xFF : delta >> 8);
+    frame[5] = uint8_t(raw & 0xFF);
+    frame[6] = uint8_t(raw >> 8);
+    frame[7] = uint8_t(filtered & 0xFF);
+    frame[8] = uint8_t(filtered >> 8);
+    frame[9] = OneWireItem::crc8(&frame[2], FRAME_SIZE - 3);
+
+    // Dropped frames only take a sequence number, the next delta reaches back to the last frame sent
+    if (out.room() >= FRAME_SIZE) {
+        out.write(frame, FRAME_SIZE);
+        lastFrame = now;
+    }
+}
@@ -0,0 +1,25 @@
+// Binary sample stream for sensor characterization
+// one frame per sample, written through the non-blocking DebugLog ring so the bus keeps being served:
+//   0xA5 0x5A | sequence (1) | time since the previous frame sent in us (2) | raw sample (2) | filter output (2) | CRC8 (1)
+// Multi byte values are LSB first, the CRC8 (1-Wire polynomial) covers sequence to filter output.
+// Frames that don't fit into the ring are dropped whole, the sequence number shows the gap.
+// extras/stream_decode.cpp turns a capture into CSV.
+
+#ifndef SAMPLESTREAM_H
+#define SAMPLESTREAM_H
+
+#include <Arduino.h>
+#include "DebugLog.h"
+
+class SampleStream {
+  public:
+
+    static constexpr uint8_t SYNC0      { 0xA5 };
+    static constexpr uint8_t SYNC1      { 0x5A };
+    static constexpr uint8_t FRAME_SIZE { 10 };
+
+    static bool due(uint16_t interval_us);   // true once interval_us passed since the last frame
+    static void send(DebugLog &out, uint16_t raw, uint16_t filtered);
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "StatusLed.h"
+#include "FastPin.h"
+
+typedef FastPin<LED_BUILTIN> Led;
+
+namespace {
+
+    constexpr uint8_t STEP_TICKS { 16 };  // ~16ms per step
+
+    struct Blink {
+        uint8_t  bits;    // LED state for the first 8 steps
+        uint16_t period;  // pattern restarts after this many steps
+    };
+
+    constexpr uint16_t steps(const uint32_t ms) {
+        return uint16_t(ms / (STEP_TICKS * 1.024));
+    }
+
+    const Blink blinks[uint8_t(StatusLed::Pattern::COUNT)] = {
+        { 0x00, 1 },                 // OFF
+        { 0x07, steps(100) },        // WARMUP
+        { 0x01, steps(30000) },      // NORMAL
+        { 0x33, steps(1000) },       // ALARM
+        { 0x55, steps(2000) },       // BUS_ERROR
+    };
+
+    volatile uint8_t current { uint8_t(StatusLed::Pattern::OFF) };
+
+    uint8_t  tick;
+    uint16_t step;
+    bool     lit;
+}
+
+// Shares Timer0 with millis(), compare B is free unless pin 5 is used for PWM
+ISR(TIMER0_COMPB_vect) {
+    if (++tick < STEP_TICKS)
+        return;
+    tick = 0;
+
+    const Blink &blink = blinks[current];
+    if (++step >= blink.period)
+        step = 0;
+
+    const bool on = (step < 8) && (blink.bits & (1 << step));
+    if (on != lit) {
+        Led::write(on);
+        lit = on;
+    }
+}
+
+void StatusLed::begin(void) {
+    Led::output();
+    Led::low();
+
+    OCR0B   = 0x80;  // anywhere in the cycle, just not at the overflow
+    TIMSK0 |= _BV(OCIE0B);
+}
+
+void StatusLed::set(const Pattern pattern) {
+    if (uint8_t(pattern) == current)
+        return;
+
+    noInterrupts();
+    current = uint8_t(pattern);
+    step    = 0xFFFF;   // start the new pattern with its first step
+    tick    = STEP_TICKS - 1;
+    interrupts();
+}
+
+StatusLed::Pattern StatusLed::get(void) {
+    return Pattern(current);
+}
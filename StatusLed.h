@@ -0,0 +1,28 @@
+// Status LED driven from a timer tick
+// Timer0 compare B fires once per Timer0 cycle (1.024ms) next to the millis() overflow interrupt,
+// so the patterns play without any work in the poll loop. Each pattern is 8 steps of 16 ticks,
+// bit n lights the LED in step n, the LED then stays off until the period is over.
+
+#ifndef STATUSLED_H
+#define STATUSLED_H
+
+#include <Arduino.h>
+
+class StatusLed {
+  public:
+
+    enum class Pattern : uint8_t {
+        OFF,
+        WARMUP,     // sensor heating up, fast blink
+        NORMAL,     // short flash every 30s
+        ALARM,      // double blink every second
+        BUS_ERROR,  // no master seen for a while, four quick flickers every 2s
+        COUNT
+    };
+
+    static void    begin(void);
+    static void    set(Pattern pattern);
+    static Pattern get(void);
+};
+
+#endif
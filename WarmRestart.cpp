@@ -0,0 +1,59 @@
+#include "WarmRestart.h"
+#include "OneWireItem.h"
+
+namespace {
+
+    constexpr uint8_t VERSION { 1 };   // bump when State changes
+
+    struct Saved {
+        uint8_t            version;
+        WarmRestart::State state;
+        uint8_t            crc;
+    };
+
+    Saved   saved __attribute__ ((section (".noinit")));
+    bool    warm;
+    uint8_t cause;
+
+    uint8_t checksum(void) {
+        return OneWireItem::crc8(reinterpret_cast<uint8_t *>(&saved), sizeof(Saved) - 1);
+    }
+}
+
+bool WarmRestart::begin(const uint8_t resetCause) {
+    cause = resetCause;
+
+    // RAM content is random after power-on, the CRC would catch that too but not reliably
+    warm = !(resetCause & _BV(PORF))
+        && (resetCause & (_BV(WDRF) | _BV(EXTRF) | _BV(BORF)))
+        && (saved.version == VERSION)
+        && (saved.crc == checksum());
+
+    if (!warm)
+        memset(&saved.state, 0, sizeof(State));
+    return warm;
+}
+
+bool WarmRestart::isWarm(void) {
+    return warm;
+}
+
+const WarmRestart::State & WarmRestart::get(void) {
+    return saved.state;
+}
+
+uint32_t WarmRestart::remaining(const uint32_t warmup) {
+    if (!warm)
+        return warmup;
+
+    uint32_t left = (saved.state.heated >= warmup) ? 0 : warmup - saved.state.heated;
+    if ((cause & _BV(BORF)) && (left < BROWNOUT_DELAY))
+        left = (warmup < BROWNOUT_DELAY) ? warmup : uint32_t(BROWNOUT_DELAY);
+    return left;
+}
+
+void WarmRestart::save(const State &state) {
+    saved.version = VERSION;
+    saved.state   = state;
+    saved.crc     = checksum();
+}
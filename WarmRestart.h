@@ -0,0 +1,32 @@
+// Warm restart after watchdog, external or brown-out resets
+// the filter, the baseline and how long the sensor has been heated are kept in .noinit RAM,
+// which the C runtime leaves alone, with a CRC8 over it. After a reset that didn't cut the power
+// the state is still valid, so the node continues where it was instead of running the full warm-up
+// and refilling the moving average from a single sample. Power-on resets always start cold.
+
+#ifndef WARMRESTART_H
+#define WARMRESTART_H
+
+#include <Arduino.h>
+
+class WarmRestart {
+  public:
+
+    static constexpr uint32_t BROWNOUT_DELAY { 10000 };  // ms, the heater was without power for a moment
+
+    struct State {
+        uint16_t filterOutput;
+        uint16_t filterTotal;
+        uint32_t baseline;     // Baseline::getState()
+        uint32_t heated;       // ms the sensor had been heated continuously
+    };
+
+    static bool     begin(uint8_t resetCause);   // MCUSR at reset, true if the saved state can be used
+    static bool     isWarm(void);
+    static const State & get(void);
+
+    static uint32_t remaining(uint32_t warmup);  // ms of the warm-up still to go
+    static void     save(const State &state);    // once per reading interval
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "Watchdog.h"
+#include <avr/wdt.h>
+
+namespace {
+    // Survive the reset, validated by their complement as .noinit is random after power-on
+    volatile uint8_t current   __attribute__ ((section (".noinit")));
+    uint16_t         resets    __attribute__ ((section (".noinit")));
+    uint16_t         resetsInv __attribute__ ((section (".noinit")));
+
+    uint8_t  stuck;
+    uint32_t timeout;
+    uint32_t lastTick;
+}
+
+void Watchdog::begin(const uint8_t resetCause, const uint32_t tickTimeout) {
+    // Unknown cause (0) counts as a power-on
+    if ((resetCause == 0) || (resetCause & _BV(PORF)) || (resets != uint16_t(~resetsInv)))
+        resets = 0;
+
+    stuck = NONE;
+    if (resetCause & _BV(WDRF)) {
+        stuck = current;
+        resets++;
+    }
+    resetsInv = ~resets;
+
+    timeout  = tickTimeout;
+    lastTick = millis();
+    current  = SETUP;
+
+    wdt_enable(WDTO_2S);
+}
+
+void Watchdog::stage(const Stage stage) {
+    current = stage;
+}
+
+void Watchdog::tick(void) {
+    lastTick = millis();
+}
+
+void Watchdog::kick(void) {
+    if (millis() - lastTick < timeout)
+        wdt_reset();
+}
+
+uint8_t Watchdog::getStuckStage(void) {
+    return stuck;
+}
+
+uint16_t Watchdog::getResets(void) {
+    return resets;
+}
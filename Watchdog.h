@@ -0,0 +1,36 @@
+// Hardware watchdog supervising the main loop
+// the watchdog is only reset when the loop proves progress: kick() right after hub.poll() returned
+// only resets it while tick() (once per reading interval) was called recently. The stage the loop is
+// in is kept in .noinit RAM, after a watchdog reset it tells where the node was stuck.
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <Arduino.h>
+
+class Watchdog {
+  public:
+
+    enum Stage : uint8_t {
+        NONE         = 0,
+        SETUP        = 1,
+        WARMUP       = 2,  // init delay
+        RESULTS      = 3,  // taking ADC results and publishing
+        HUB_POLL     = 4,
+        ADC_SERVICE  = 5,  // AdcScheduler::service()
+        LOG          = 6,  // serial output, sample stream
+        SLEEP        = 7,
+        END_INTERVAL = 8,
+    };
+
+    static void     begin(uint8_t resetCause, uint32_t tickTimeout); // tickTimeout: ms without tick() before kicks stop
+
+    static void     stage(Stage stage);
+    static void     tick(void);
+    static void     kick(void);
+
+    static uint8_t  getStuckStage(void);   // stage at the last watchdog reset, NONE if there was none
+    static uint16_t getResets(void);       // watchdog resets since power-on
+};
+
+#endif
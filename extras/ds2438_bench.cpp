@@ -0,0 +1,54 @@
+// Benchmark and self check for the DS2438 batch decoder
+//   g++ -std=c++14 -O3 -march=native -o ds2438_bench ds2438_bench.cpp ds2438_decode.cpp
+//   ./ds2438_bench [records]
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "ds2438_decode.h"
+#include "onewire_crc.h"
+
+int main(int argc, char **argv) {
+    const size_t count = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 10000000;
+
+    // Archive-like data: mostly good records, every 1000th one corrupted on the bus
+    std::vector<uint8_t> records(count * ds2438::RECORD_SIZE);
+    std::mt19937         random(42);
+    for (size_t i = 0; i < count; ++i) {
+        uint8_t *r = &records[i * ds2438::RECORD_SIZE];
+        const uint16_t ppm = (i % 100 == 99) ? ds2438::PPM_SATURATED : uint16_t(random() % 10000);
+        r[0] = uint8_t(ppm & 0xFF);
+        r[1] = uint8_t(ppm >> 8);
+        r[2] = r[3] = r[4] = r[5] = r[6] = r[7] = 0;
+        r[8] = onewire::crc8(r, 8);
+        if (i % 1000 == 999)
+            r[1] ^= 0x01;
+    }
+
+    std::vector<double>  ppm(count);
+    std::vector<uint8_t> valid(count);
+
+    const auto   start   = std::chrono::steady_clock::now();
+    const size_t good    = ds2438::decode(records.data(), count, ppm.data(), valid.data());
+    const auto   stop    = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(stop - start).count();
+
+    // Compare against the single value reference
+    size_t mismatch = 0;
+    for (size_t i = 0; i < count; ++i) {
+        const uint8_t *r = &records[i * ds2438::RECORD_SIZE];
+        if (!valid[i])
+            continue;
+        const double expected = ds2438::ppm(r);
+        if (std::fabs(expected - ppm[i]) > 1e-6 * std::fabs(expected))
+            ++mismatch;
+    }
+
+    printf("%zu records, %zu valid, %zu mismatches\n", count, good, mismatch);
+    printf("%.3f s, %.1f M records/s\n", seconds, count / seconds / 1e6);
+    return mismatch ? 1 : 0;
+}
@@ -0,0 +1,79 @@
+#include "ds2438_decode.h"
+#include "onewire_crc.h"
+
+#include <cmath>
+#include <limits>
+
+namespace ds2438 {
+
+    namespace {
+
+        constexpr size_t BLOCK { 1024 };  // records per pass, keeps the SoA arrays in L1
+
+        // 4 independent CRC chains, so the table lookups of different records overlap
+        inline void checkBlock(const uint8_t *records, const size_t count, uint8_t *ok) {
+            const uint8_t *table = onewire::crc8Table.value;
+
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const uint8_t *r0 = &records[(i + 0) * RECORD_SIZE];
+                const uint8_t *r1 = &records[(i + 1) * RECORD_SIZE];
+                const uint8_t *r2 = &records[(i + 2) * RECORD_SIZE];
+                const uint8_t *r3 = &records[(i + 3) * RECORD_SIZE];
+
+                uint8_t c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+                for (size_t n = 0; n < RECORD_SIZE - 1; ++n) {
+                    c0 = table[c0 ^ r0[n]];
+                    c1 = table[c1 ^ r1[n]];
+                    c2 = table[c2 ^ r2[n]];
+                    c3 = table[c3 ^ r3[n]];
+                }
+
+                ok[i + 0] = (c0 == r0[RECORD_SIZE - 1]);
+                ok[i + 1] = (c1 == r1[RECORD_SIZE - 1]);
+                ok[i + 2] = (c2 == r2[RECORD_SIZE - 1]);
+                ok[i + 3] = (c3 == r3[RECORD_SIZE - 1]);
+            }
+
+            for (; i < count; ++i) {
+                const uint8_t *r = &records[i * RECORD_SIZE];
+                ok[i] = (onewire::crc8(r, RECORD_SIZE - 1) == r[RECORD_SIZE - 1]);
+            }
+        }
+    }
+
+    size_t decode(const uint8_t * const records, const size_t count, double * const ppm, uint8_t * const valid) {
+        constexpr double invalid = std::numeric_limits<double>::quiet_NaN();
+
+        uint16_t raw[BLOCK];
+        uint8_t  ok[BLOCK];
+
+        size_t good = 0;
+        for (size_t start = 0; start < count; start += BLOCK) {
+            const size_t   n     = (count - start < BLOCK) ? (count - start) : BLOCK;
+            const uint8_t *block = &records[start * RECORD_SIZE];
+
+            checkBlock(block, n, ok);
+
+            // Unpack into plain arrays, the stride of 9 would keep the compiler from vectorizing the math
+            for (size_t i = 0; i < n; ++i) {
+                const uint8_t *r = &block[i * RECORD_SIZE];
+                raw[i] = uint16_t(r[0] | (r[1] << 8));
+            }
+
+            // Same as ds2438::ppm(), written so it vectorizes
+            double * const out = &ppm[start];
+            for (size_t i = 0; i < n; ++i)
+                out[i] = ok[i] ? double(raw[i]) : invalid;
+
+            for (size_t i = 0; i < n; ++i)
+                good += ok[i];
+
+            if (valid != nullptr)
+                for (size_t i = 0; i < n; ++i)
+                    valid[start + i] = ok[i];
+        }
+
+        return good;
+    }
+}
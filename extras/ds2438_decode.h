@@ -0,0 +1,29 @@
+// Batch decoder for DS2438 page 3 dumps of the node
+// a record is the 9 bytes Read Scratchpad returns for page 3: 8 data bytes and their CRC8.
+// With USE_PPM the node converts the filtered reading itself (see MQ135As1W.ino, Mq135Curve.h) and
+// publishes the result in page 3 bytes 0-1, LSB first, saturating at 65535. Page 0 VAD carries the
+// raw ADC counts and no longer encodes ppm.
+
+#ifndef DS2438_DECODE_H
+#define DS2438_DECODE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace ds2438 {
+
+    constexpr size_t   RECORD_SIZE   { 9 };
+    constexpr uint16_t PPM_SATURATED { 0xFFFF };  // at or above the node's range
+
+    // Single value, reference for the batch decoder
+    inline double ppm(const uint8_t *record) {
+        return uint16_t(record[0] | (record[1] << 8));
+    }
+
+    // Decodes count records laid out back-to-back. ppm[i] is NaN and valid[i] is 0 for records
+    // with a bad CRC, valid may be nullptr. Saturated readings decode as PPM_SATURATED and stay valid.
+    // Returns the number of valid records.
+    size_t decode(const uint8_t *records, size_t count, double *ppm, uint8_t *valid = nullptr);
+}
+
+#endif
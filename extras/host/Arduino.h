@@ -0,0 +1,116 @@
+// Arduino core API for the host build, see host.h
+// only what the sketch and its modules use, with the AVR core's semantics (min/max are macros,
+// unsigned long is cut to 32 bits where the AVR would wrap).
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define HIGH 1
+#define LOW  0
+
+#define INPUT        0
+#define OUTPUT       1
+#define INPUT_PULLUP 2
+
+#define DEFAULT  1
+#define INTERNAL 3
+#define EXTERNAL 0
+
+#define DEC 10
+#define HEX 16
+
+#define LED_BUILTIN 13
+
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
+#ifndef min
+  #define min(a,b) ((a)<(b)?(a):(b))
+  #define max(a,b) ((a)>(b)?(a):(b))
+#endif
+#define constrain(amt,low,high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+unsigned long millis(void);
+unsigned long micros(void);
+void          delay(unsigned long ms);
+void          delayMicroseconds(unsigned int us);
+
+void          pinMode(uint8_t pin, uint8_t mode);
+void          digitalWrite(uint8_t pin, uint8_t value);
+int           digitalRead(uint8_t pin);
+int           analogRead(uint8_t pin);
+void          analogWrite(uint8_t pin, int value);
+void          analogReference(uint8_t mode);
+
+inline void   noInterrupts(void) {}
+inline void   interrupts(void) {}
+
+// Pin tables of the ATmega328P variant: 0-7 PORTD, 8-13 PORTB, 14-19 PORTC
+#define NOT_A_PORT 0
+#define PB 2
+#define PC 3
+#define PD 4
+
+inline uint8_t digitalPinToPort(uint8_t pin)    { return (pin < 8) ? PD : (pin < 14) ? PB : (pin < 20) ? PC : NOT_A_PORT; }
+inline uint8_t digitalPinToBitMask(uint8_t pin) { return uint8_t(_BV((pin < 8) ? pin : (pin < 14) ? pin - 8 : pin - 14)); }
+inline volatile uint8_t * portInputRegister(uint8_t port)  { return (port == PB) ? &PINB  : (port == PC) ? &PINC  : &PIND; }
+inline volatile uint8_t * portOutputRegister(uint8_t port) { return (port == PB) ? &PORTB : (port == PC) ? &PORTC : &PORTD; }
+inline volatile uint8_t * portModeRegister(uint8_t port)   { return (port == PB) ? &DDRB  : (port == PC) ? &DDRC  : &DDRD; }
+
+#define digitalPinToPCICR(p)    (&PCICR)
+#define digitalPinToPCICRbit(p) (((p) <= 7) ? 2 : (((p) <= 13) ? 0 : 1))
+#define digitalPinToPCMSK(p)    (((p) <= 7) ? (&PCMSK2) : (((p) <= 13) ? (&PCMSK0) : (&PCMSK1)))
+#define digitalPinToPCMSKbit(p) (((p) <= 7) ? (p) : (((p) <= 13) ? ((p) - 8) : ((p) - 14)))
+
+class Print {
+  public:
+    virtual ~Print(void) {}
+
+    virtual size_t write(uint8_t value) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *text) { return write(reinterpret_cast<const uint8_t *>(text), strlen(text)); }
+
+    size_t print(const char *text) { return write(text); }
+    size_t print(char value)       { return write(uint8_t(value)); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long) value, base); }
+    size_t print(int value, int base = DEC)           { return print((long) value, base); }
+    size_t print(unsigned int value, int base = DEC)  { return print((unsigned long) value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    size_t println(void) { return write("\r\n"); }
+    template<class T> size_t println(T value)            { const size_t n = print(value); return n + println(); }
+    template<class T> size_t println(T value, int base)  { const size_t n = print(value, base); return n + println(); }
+};
+
+class HardwareSerial : public Print {
+  public:
+    void   begin(unsigned long baud);
+    int    availableForWrite(void);   // TX buffer room, drains at the baud rate on the virtual clock
+    size_t write(uint8_t value) override;
+    using Print::write;
+};
+
+extern HardwareSerial Serial;
+
+#endif
@@ -0,0 +1,17 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+#include <stdint.h>
+
+// 1024 bytes, erased (0xFF) unless host::loadEeprom() filled them
+class EEPROMClass {
+  public:
+    uint8_t  read(int address);
+    void     write(int address, uint8_t value);
+    void     update(int address, uint8_t value);
+    uint16_t length(void) { return 1024; }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
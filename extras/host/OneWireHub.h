@@ -0,0 +1,32 @@
+#ifndef HOST_ONEWIREHUB_H
+#define HOST_ONEWIREHUB_H
+
+#include <Arduino.h>
+
+constexpr bool OVERDRIVE_ENABLE { false };
+
+class OneWireItem;
+
+// Same interface as OneWireHub. The bus is modelled per transaction (see host.h): a reset pulse on the
+// pin, presence and Match ROM cost their slot time, then the attached device's duty() gets the
+// function command and its data
+class OneWireHub {
+  private:
+    OneWireItem *item;
+
+  public:
+    explicit OneWireHub(uint8_t pin);
+
+    uint8_t attach(OneWireItem &sensor);
+    bool    detach(const OneWireItem &sensor);
+    bool    poll(void);
+
+    bool    send(const uint8_t *address, uint8_t data_length = 1);
+    bool    send(const uint8_t *address, uint8_t data_length, uint16_t &crc16);
+    bool    send(uint8_t dataByte);
+    bool    recv(uint8_t *address, uint8_t data_length = 1);
+    bool    recv(uint8_t *address, uint8_t data_length, uint16_t &crc16);
+    void    raiseSlaveError(uint8_t cmd = 0);
+};
+
+#endif
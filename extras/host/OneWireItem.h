@@ -0,0 +1,21 @@
+#ifndef HOST_ONEWIREITEM_H
+#define HOST_ONEWIREITEM_H
+
+#include "OneWireHub.h"
+
+// Same interface as OneWireHub's OneWireItem
+class OneWireItem {
+  public:
+    OneWireItem(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7);
+    virtual ~OneWireItem(void) {}
+
+    uint8_t ID[8];
+
+    virtual void duty(OneWireHub *hub) = 0;
+
+    static uint8_t  crc8(const uint8_t *address, uint8_t length, uint8_t crc_init = 0);
+    static uint16_t crc16(const uint8_t *address, uint8_t length, uint16_t crc_init = 0);
+    static uint16_t crc16(uint8_t value, uint16_t crc);
+};
+
+#endif
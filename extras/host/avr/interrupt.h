@@ -0,0 +1,11 @@
+#ifndef HOST_AVR_INTERRUPT_H
+#define HOST_AVR_INTERRUPT_H
+
+// Vectors are plain functions, the host core calls the ones it emulates (Timer0 compare B, watchdog)
+#define ISR(vector)             extern "C" void vector(void); extern "C" void vector(void)
+#define EMPTY_INTERRUPT(vector) extern "C" void vector(void); extern "C" void vector(void) {}
+
+#define cli()
+#define sei()
+
+#endif
@@ -0,0 +1,79 @@
+// ATmega328P registers for the host build
+// plain variables, except ADCSRA: starting a conversion there produces a result from the injected
+// ADC traces, and ADSC stays set until the conversion time has passed on the virtual clock.
+
+#ifndef HOST_AVR_IO_H
+#define HOST_AVR_IO_H
+
+#include <stdint.h>
+
+#ifndef F_CPU
+  #define F_CPU 16000000UL
+#endif
+
+#define _BV(bit) (1 << (bit))
+
+class HostAdcsra {
+  public:
+    operator uint8_t() const;
+    HostAdcsra & operator=(uint8_t value);
+    HostAdcsra & operator|=(uint8_t value) { return *this = uint8_t(uint8_t(*this) | value); }
+    HostAdcsra & operator&=(uint8_t value) { return *this = uint8_t(uint8_t(*this) & value); }
+};
+
+extern HostAdcsra        ADCSRA;
+extern volatile uint8_t  ADMUX;
+extern volatile uint16_t ADC;
+extern volatile uint8_t  ADCSRB, DIDR0;
+
+extern volatile uint8_t  MCUSR, WDTCSR;
+extern volatile uint8_t  TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0, TIFR0;
+extern volatile uint8_t  TCCR1A, TCCR1B, TIMSK1;
+extern volatile uint16_t TCNT1, OCR1A, OCR1B;
+extern volatile uint8_t  PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+extern volatile uint8_t  PORTB, DDRB, PINB, PORTC, DDRC, PINC, PORTD, DDRD, PIND;
+
+// ADMUX
+#define REFS1 7
+#define REFS0 6
+#define ADLAR 5
+
+// ADCSRA
+#define ADEN  7
+#define ADSC  6
+#define ADATE 5
+#define ADIF  4
+#define ADIE  3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+
+// MCUSR
+#define WDRF  3
+#define BORF  2
+#define EXTRF 1
+#define PORF  0
+
+// WDTCSR
+#define WDIF  7
+#define WDIE  6
+#define WDP3  5
+#define WDCE  4
+#define WDE   3
+
+// TIMSK0
+#define OCIE0B 2
+#define OCIE0A 1
+#define TOIE0  0
+
+// PCICR
+#define PCIE2  2
+#define PCIE1  1
+#define PCIE0  0
+
+// RAM the stack diagnostics scan, see host_ram.cpp. The end is only known there, so the compiler
+// doesn't take __heap_start for a single byte
+extern uint8_t * const hostRamEnd;
+#define RAMEND hostRamEnd
+
+#endif
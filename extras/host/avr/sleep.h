@@ -0,0 +1,14 @@
+#ifndef HOST_AVR_SLEEP_H
+#define HOST_AVR_SLEEP_H
+
+#include <stdint.h>
+
+#define SLEEP_MODE_IDLE 0
+#define SLEEP_MODE_ADC  1
+
+void set_sleep_mode(uint8_t mode);
+void sleep_enable(void);
+void sleep_disable(void);
+void sleep_cpu(void);   // advances the virtual clock to the next wake up
+
+#endif
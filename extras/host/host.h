@@ -0,0 +1,70 @@
+// Host side of the Linux build of the sketch
+// the sketch and its modules compile unchanged against the shim headers in this directory. Time only
+// moves on a virtual clock: every millis()/micros() call costs CLOCK_READ_US, hub.poll() costs the poll
+// cost plus the bus time of any transaction it serves, ADC conversions take their real conversion time
+// and sleep_cpu() jumps to the next wake up. So loop() runs much faster than real time.
+// The bus is modelled at transaction level: the master's reset pulse pulls the bus pin low (waking a
+// pin-change sleep), and the hub only accepts the reset if poll() sees at least RESET_MIN_US of it.
+// Presence, Match ROM and the function bytes then cost their standard speed slot time. The time from
+// the reset edge to the poll() that caught it is what the node has to keep short, see Stats.
+// Not modelled: the CPU time of the sketch's own code (only the operations above move the clock, so
+// latencies are lower bounds), the hub's bit-level sampling within the slots, and overdrive.
+
+#ifndef HOST_H
+#define HOST_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+namespace host {
+
+    constexpr uint32_t CLOCK_READ_US { 1 };
+    constexpr uint32_t RESET_MIN_US  { 430 };  // OneWireHub's ONEWIRE_TIME_RESET_MIN, standard speed
+    constexpr uint32_t WAKE_US       { 1 };    // idle and ADC noise reduction sleep, wake up and empty ISR
+
+    struct TracePoint {
+        double   seconds;   // virtual time
+        uint16_t value;     // raw ADC counts, linear in between, held after the last point
+    };
+
+    struct Transaction {
+        uint64_t             at;        // virtual us the reset pulse starts
+        std::vector<uint8_t> request;   // function command and its data, sent after Match ROM
+        std::vector<uint8_t> response;  // filled in when served
+        bool                 served;
+        bool                 missed;    // poll() came too late, no presence: the master has to retry
+    };
+
+    struct Stats {
+        uint64_t polls;
+        uint64_t conversions;
+        uint64_t sleeps;
+        uint64_t sleptUs;
+        uint32_t watchdogExpiries;      // the chip would have reset
+        uint32_t slaveErrors;
+        uint32_t transactions;
+        uint32_t missedResets;
+        uint32_t resetLatencyMax;       // us from the reset edge to the poll() that saw it
+        uint64_t resetLatencyTotal;     // of the transactions served, for the mean
+    };
+
+    uint64_t now(void);                 // virtual us since power-on
+    void     advance(uint64_t us);      // runs the emulated timer and watchdog interrupts on the way
+
+    void     setPollCost(uint32_t us);
+    void     setResetLow(uint32_t us);  // master's reset pulse, default 480us
+    void     setTrace(uint8_t channel, const std::vector<TracePoint> &trace);  // analog pins 0-7
+    bool     loadTrace(uint8_t channel, const char *path);                     // lines "seconds value"
+    void     setInternal(uint16_t temperatureRaw, uint16_t vcc_mV);            // internal ADC channels
+
+    bool     loadEeprom(const char *path);
+    bool     saveEeprom(const char *path);
+
+    void     setSerial(FILE *out);      // nullptr drops serial output
+
+    void     schedule(Transaction &transaction);  // has to stay valid until served
+    const Stats & stats(void);
+}
+
+#endif
@@ -0,0 +1,619 @@
+// Emulated core for the host build, see host.h
+
+// Standard headers first, Arduino.h defines min() and max() as macros
+#include <deque>
+#include <vector>
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <avr/sleep.h>
+#include <avr/wdt.h>
+
+#include "OneWireHub.h"
+#include "OneWireItem.h"
+#include "host.h"
+
+// Vectors the sketch may define, called on the virtual clock
+extern "C" void TIMER0_COMPB_vect(void) __attribute__ ((weak));
+extern "C" void WDT_vect(void)          __attribute__ ((weak));
+extern "C" void ADC_vect(void)          __attribute__ ((weak));
+
+HostAdcsra        ADCSRA;
+volatile uint8_t  ADMUX;
+volatile uint16_t ADC;
+volatile uint8_t  ADCSRB, DIDR0;
+
+volatile uint8_t  MCUSR, WDTCSR;
+volatile uint8_t  TCCR0A, TCCR0B, TCNT0, OCR0A, OCR0B, TIMSK0 { _BV(TOIE0) }, TIFR0;
+volatile uint8_t  TCCR1A, TCCR1B, TIMSK1;
+volatile uint16_t TCNT1, OCR1A, OCR1B;
+volatile uint8_t  PCICR, PCIFR, PCMSK0, PCMSK1, PCMSK2;
+volatile uint8_t  PORTB, DDRB, PINB { 0xFF }, PORTC, DDRC, PINC { 0xFF }, PORTD, DDRD, PIND { 0xFF };  // pulled up, bus idle
+
+HardwareSerial Serial;
+EEPROMClass    EEPROM;
+
+namespace {
+
+    constexpr uint32_t TIMER0_US   { 1024 };  // Timer0 overflow, millis() and the status LED tick
+    constexpr uint32_t WDT_IRQ_US  { 16000 };
+    constexpr uint32_t SLOT_US     { 65 };    // 1-Wire standard speed time slot
+    constexpr uint32_t PRESENCE_US { 480 };   // master waits this long after the reset for presence
+    constexpr uint32_t UART_BYTE_US { 87 };   // 115200 baud, 10 bits
+    constexpr uint8_t  UART_BUFFER { 64 };
+
+    uint64_t    clock;
+    uint32_t    pollCost { 10 };
+    host::Stats counters;
+
+    std::vector<host::TracePoint> traces[8];
+    uint16_t    temperatureRaw { 354 };   // ~25degC with Compensation::toDegC()
+    uint16_t    vcc            { 5000 };
+
+    // ADC
+    uint8_t     adcsra { _BV(ADEN) | _BV(ADPS2) | _BV(ADPS1) | _BV(ADPS0) };  // as set up by init()
+    uint64_t    adcDone;
+    uint16_t    adcResult;
+
+    // Sleep
+    uint8_t     sleepMode;
+    bool        sleepEnabled;
+
+    // Watchdog
+    bool        wdtEnabled;
+    uint32_t    wdtTimeout;
+    uint64_t    wdtLast;
+
+    // Serial
+    FILE       *serialOut;
+    uint64_t    uartDrained;
+    uint16_t    uartLevel;
+
+    // 1-Wire
+    uint32_t                        resetLow { 480 };
+    volatile uint8_t               *busInput;
+    uint8_t                         busMask;
+    volatile uint8_t               *busPcmsk;
+    uint8_t                         busPcmskMask;
+    uint8_t                         busPcicrMask;
+    std::deque<host::Transaction *> transactions;
+    const std::vector<uint8_t>     *request;
+    std::vector<uint8_t>           *response;
+    size_t                          requestPos;
+
+    uint8_t     eeprom[1024];
+    bool        eepromInit;
+
+    uint8_t *eepromData(void) {
+        if (!eepromInit) {
+            memset(eeprom, 0xFF, sizeof(eeprom));
+            eepromInit = true;
+        }
+        return eeprom;
+    }
+
+    uint16_t traceValue(const uint8_t channel) {
+        const std::vector<host::TracePoint> &trace = traces[channel & 0x07];
+        if (trace.empty())
+            return 0;
+
+        const double t = clock / 1e6;
+        if (t <= trace.front().seconds)
+            return trace.front().value;
+
+        for (size_t i = 1; i < trace.size(); ++i) {
+            if (t < trace[i].seconds) {
+                const host::TracePoint &a = trace[i - 1];
+                const host::TracePoint &b = trace[i];
+                return uint16_t(lround(a.value + (b.value - a.value) * (t - a.seconds) / (b.seconds - a.seconds)));
+            }
+        }
+        return trace.back().value;
+    }
+
+    uint16_t adcInput(const uint8_t admux) {
+        const uint8_t channel = admux & 0x0F;
+        if (channel < 8)
+            return traceValue(channel);
+        if (channel == 0x08)
+            return temperatureRaw;
+        if (channel == 0x0E)
+            return uint16_t(min(1023UL, 1100UL * 1023 / vcc));
+        return 0;
+    }
+
+    uint32_t conversionUs(const bool first) {
+        const uint8_t  ps     = adcsra & 0x07;
+        const uint32_t cycles = (first ? 25 : 13) * ((ps == 0) ? 2 : (1 << ps));
+        return uint32_t(cycles / (F_CPU / 1000000UL));
+    }
+
+    void updateAdc(void) {
+        if ((adcsra & _BV(ADSC)) && (clock >= adcDone)) {
+            adcsra &= ~_BV(ADSC);
+            adcsra |= _BV(ADIF);
+            ADC = adcResult;
+            ++counters.conversions;
+            if ((adcsra & _BV(ADIE)) && ADC_vect)
+                ADC_vect();
+        }
+    }
+
+    void drainUart(void) {
+        const uint64_t bytes = (clock - uartDrained) / UART_BYTE_US;
+        if (bytes >= uartLevel) {
+            uartLevel   = 0;
+            uartDrained = clock;
+        } else {
+            uartLevel   -= uint16_t(bytes);
+            uartDrained += bytes * UART_BYTE_US;
+        }
+    }
+
+    // Bus pin follows the reset pulse of the next transaction, high otherwise
+    void updateBus(void) {
+        if (busInput == nullptr)
+            return;
+
+        if (!transactions.empty() && (clock >= transactions.front()->at) && (clock < transactions.front()->at + resetLow))
+            *busInput &= ~busMask;
+        else
+            *busInput |= busMask;
+    }
+
+    // Next edge on the bus pin after now, UINT64_MAX if there is none or the pin-change interrupt is off
+    uint64_t nextBusEdge(void) {
+        if ((busInput == nullptr) || transactions.empty() || !(PCICR & busPcicrMask) || !(*busPcmsk & busPcmskMask))
+            return UINT64_MAX;
+
+        const uint64_t fall = transactions.front()->at;
+        if (fall > clock)
+            return fall;
+        if (fall + resetLow > clock)
+            return fall + resetLow;
+        return UINT64_MAX;
+    }
+
+    void serve(host::Transaction &transaction, OneWireHub &hub, OneWireItem &item) {
+        // The hub waits for the end of the reset, answers with presence and follows Match ROM
+        host::advance(transaction.at + resetLow - clock);
+        host::advance(PRESENCE_US + 9 * 8 * SLOT_US);
+
+        request    = &transaction.request;
+        response   = &transaction.response;
+        requestPos = 0;
+
+        if (!transaction.request.empty())
+            item.duty(&hub);
+
+        transaction.served = true;
+        ++counters.transactions;
+        request  = nullptr;
+        response = nullptr;
+
+        // Function command bytes both ways
+        host::advance((transaction.request.size() + transaction.response.size()) * 8 * SLOT_US);
+    }
+}
+
+// Virtual clock
+
+uint64_t host::now(void) {
+    return clock;
+}
+
+void host::advance(const uint64_t us) {
+    const uint64_t end = clock + us;
+
+    while (clock < end) {
+        // Step to the next timer event, the interrupts see the time they fire at
+        const uint64_t timer = (clock / TIMER0_US + 1) * TIMER0_US;
+        const uint64_t wdt   = (clock / WDT_IRQ_US + 1) * WDT_IRQ_US;
+        const uint64_t next  = min(end, min(timer, wdt));
+        clock = next;
+        TCNT0 = uint8_t(clock / 4);
+
+        if ((clock == timer) && (TIMSK0 & _BV(OCIE0B)) && TIMER0_COMPB_vect)
+            TIMER0_COMPB_vect();
+        if ((clock == wdt) && (WDTCSR & _BV(WDIE)) && WDT_vect)
+            WDT_vect();
+    }
+    updateBus();
+
+    if (wdtEnabled && (clock - wdtLast > wdtTimeout)) {
+        ++counters.watchdogExpiries;
+        wdtLast = clock;
+    }
+}
+
+void host::setPollCost(const uint32_t us) {
+    pollCost = us;
+}
+
+void host::setResetLow(const uint32_t us) {
+    resetLow = us;
+}
+
+void host::setTrace(const uint8_t channel, const std::vector<TracePoint> &trace) {
+    traces[channel & 0x07] = trace;
+}
+
+bool host::loadTrace(const uint8_t channel, const char * const path) {
+    FILE *file = fopen(path, "r");
+    if (file == nullptr)
+        return false;
+
+    std::vector<TracePoint> trace;
+    char line[128];
+    while (fgets(line, sizeof(line), file)) {
+        double   seconds;
+        unsigned value;
+        if ((line[0] != '#') && (sscanf(line, "%lf %u", &seconds, &value) == 2))
+            trace.push_back({ seconds, uint16_t(min(value, 1023u)) });
+    }
+    fclose(file);
+
+    setTrace(channel, trace);
+    return !trace.empty();
+}
+
+void host::setInternal(const uint16_t temperature, const uint16_t vcc_mV) {
+    temperatureRaw = temperature;
+    vcc            = vcc_mV ? vcc_mV : 1;
+}
+
+bool host::loadEeprom(const char * const path) {
+    FILE *file = fopen(path, "rb");
+    if (file == nullptr)
+        return false;
+
+    const size_t read = fread(eepromData(), 1, sizeof(eeprom), file);
+    fclose(file);
+    return read == sizeof(eeprom);
+}
+
+bool host::saveEeprom(const char * const path) {
+    FILE *file = fopen(path, "wb");
+    if (file == nullptr)
+        return false;
+
+    const size_t written = fwrite(eepromData(), 1, sizeof(eeprom), file);
+    fclose(file);
+    return written == sizeof(eeprom);
+}
+
+void host::setSerial(FILE * const out) {
+    serialOut = out;
+}
+
+void host::schedule(Transaction &transaction) {
+    transaction.served = false;
+    transaction.missed = false;
+    transaction.response.clear();
+    transactions.push_back(&transaction);
+}
+
+const host::Stats & host::stats(void) {
+    return counters;
+}
+
+// Arduino core
+
+unsigned long millis(void) {
+    host::advance(host::CLOCK_READ_US);
+    return uint32_t(clock / 1000);
+}
+
+unsigned long micros(void) {
+    host::advance(host::CLOCK_READ_US);
+    return uint32_t(clock);
+}
+
+void delay(const unsigned long ms) {
+    host::advance(uint64_t(ms) * 1000);
+}
+
+void delayMicroseconds(const unsigned int us) {
+    host::advance(us);
+}
+
+void pinMode(const uint8_t pin, const uint8_t mode) {
+    volatile uint8_t *ddr = portModeRegister(digitalPinToPort(pin));
+    if (mode == OUTPUT)
+        *ddr |= digitalPinToBitMask(pin);
+    else
+        *ddr &= ~digitalPinToBitMask(pin);
+}
+
+void digitalWrite(const uint8_t pin, const uint8_t value) {
+    volatile uint8_t *port = portOutputRegister(digitalPinToPort(pin));
+    if (value)
+        *port |= digitalPinToBitMask(pin);
+    else
+        *port &= ~digitalPinToBitMask(pin);
+}
+
+int digitalRead(const uint8_t pin) {
+    return (*portInputRegister(digitalPinToPort(pin)) & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+int analogRead(const uint8_t pin) {
+    ADMUX = _BV(REFS0) | (((pin >= A0) ? pin - A0 : pin) & 0x07);
+    host::advance(conversionUs(false));
+    ++counters.conversions;
+    return adcInput(ADMUX);
+}
+
+void analogWrite(const uint8_t pin, const int value) {
+    pinMode(pin, OUTPUT);
+    digitalWrite(pin, (value >= 128) ? HIGH : LOW);
+}
+
+void analogReference(const uint8_t) {
+}
+
+// ADC
+
+HostAdcsra::operator uint8_t() const {
+    updateAdc();
+    return adcsra;
+}
+
+HostAdcsra & HostAdcsra::operator=(const uint8_t value) {
+    updateAdc();
+
+    const bool enabling = (value & _BV(ADEN)) && !(adcsra & _BV(ADEN));
+    const bool starting = (value & _BV(ADSC)) && (value & _BV(ADEN)) && !(adcsra & _BV(ADSC));
+
+    // ADIF is cleared by writing one, writing zero to ADSC has no effect
+    adcsra = uint8_t((value & ~_BV(ADIF)) | (adcsra & _BV(ADIF) & ~value) | (adcsra & _BV(ADSC)));
+    if (starting) {
+        adcResult = adcInput(ADMUX);
+        adcDone   = clock + conversionUs(enabling);
+    }
+    return *this;
+}
+
+// Sleep
+
+void set_sleep_mode(const uint8_t mode) {
+    sleepMode = mode;
+}
+
+void sleep_enable(void) {
+    sleepEnabled = true;
+}
+
+void sleep_disable(void) {
+    sleepEnabled = false;
+}
+
+void sleep_cpu(void) {
+    if (!sleepEnabled)
+        return;
+
+    // Wake up on the next Timer0 interrupt (halted in ADC mode), the ADC or a bus pin change
+    uint64_t wake = (sleepMode == SLEEP_MODE_ADC) ? UINT64_MAX : (clock / TIMER0_US + 1) * TIMER0_US;
+    if (adcsra & _BV(ADSC))
+        wake = min(wake, adcDone);
+    wake = min(wake, nextBusEdge());
+    if (wake == UINT64_MAX)
+        wake = clock + TIMER0_US;
+
+    ++counters.sleeps;
+    counters.sleptUs += wake - clock;
+    host::advance(wake - clock + host::WAKE_US);
+}
+
+// Watchdog
+
+void wdt_enable(const uint8_t timeout) {
+    wdtEnabled = true;
+    wdtTimeout = 16000UL << timeout;
+    wdtLast    = clock;
+}
+
+void wdt_disable(void) {
+    wdtEnabled = false;
+    WDTCSR     = 0;
+}
+
+void wdt_reset(void) {
+    wdtLast = clock;
+}
+
+// Serial
+
+size_t Print::write(const uint8_t *buffer, size_t size) {
+    size_t written = 0;
+    while (size--)
+        written += write(*buffer++);
+    return written;
+}
+
+size_t Print::print(const long value, const int base) {
+    char text[24];
+    snprintf(text, sizeof(text), (base == HEX) ? "%lX" : "%ld", value);
+    return write(text);
+}
+
+size_t Print::print(const unsigned long value, const int base) {
+    char text[24];
+    snprintf(text, sizeof(text), (base == HEX) ? "%lX" : "%lu", value);
+    return write(text);
+}
+
+size_t Print::print(const double value, const int digits) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", digits, value);
+    return write(text);
+}
+
+void HardwareSerial::begin(unsigned long) {
+    uartLevel   = 0;
+    uartDrained = clock;
+}
+
+int HardwareSerial::availableForWrite(void) {
+    drainUart();
+    return UART_BUFFER - 1 - uartLevel;
+}
+
+size_t HardwareSerial::write(const uint8_t value) {
+    // Blocks like the real one when the TX buffer is full
+    drainUart();
+    if (uartLevel >= UART_BUFFER - 1) {
+        host::advance(UART_BYTE_US);
+        drainUart();
+    }
+    ++uartLevel;
+
+    if (serialOut != nullptr)
+        fputc(value, serialOut);
+    return 1;
+}
+
+// EEPROM
+
+uint8_t EEPROMClass::read(const int address) {
+    return eepromData()[address & 0x3FF];
+}
+
+void EEPROMClass::write(const int address, const uint8_t value) {
+    eepromData()[address & 0x3FF] = value;
+    host::advance(3400);   // erase and write
+}
+
+void EEPROMClass::update(const int address, const uint8_t value) {
+    if (read(address) != value)
+        write(address, value);
+}
+
+// OneWireHub
+
+OneWireItem::OneWireItem(uint8_t ID1, uint8_t ID2, uint8_t ID3, uint8_t ID4, uint8_t ID5, uint8_t ID6, uint8_t ID7) {
+    ID[0] = ID1;
+    ID[1] = ID2;
+    ID[2] = ID3;
+    ID[3] = ID4;
+    ID[4] = ID5;
+    ID[5] = ID6;
+    ID[6] = ID7;
+    ID[7] = crc8(ID, 7);
+}
+
+uint8_t OneWireItem::crc8(const uint8_t *address, uint8_t length, uint8_t crc) {
+    while (length--) {
+        uint8_t in = *address++;
+        for (uint8_t i = 0; i < 8; ++i) {
+            const bool mix = (crc ^ in) & 0x01;
+            crc >>= 1;
+            if (mix)
+                crc ^= 0x8C;
+            in >>= 1;
+        }
+    }
+    return crc;
+}
+
+uint16_t OneWireItem::crc16(const uint8_t *address, uint8_t length, uint16_t crc) {
+    while (length--)
+        crc = crc16(*address++, crc);
+    return crc;
+}
+
+uint16_t OneWireItem::crc16(const uint8_t value, uint16_t crc) {
+    static const uint8_t oddParity[16] = { 0, 1, 1, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0, 1, 1, 0 };
+
+    uint16_t data = (value ^ crc) & 0xFF;
+    crc >>= 8;
+    if (oddParity[data & 0x0F] ^ oddParity[data >> 4])
+        crc ^= 0xC001;
+    data <<= 6;
+    crc ^= data;
+    data <<= 1;
+    crc ^= data;
+    return crc;
+}
+
+OneWireHub::OneWireHub(const uint8_t pin) : item(nullptr) {
+    busInput     = portInputRegister(digitalPinToPort(pin));
+    busMask      = digitalPinToBitMask(pin);
+    busPcmsk     = digitalPinToPCMSK(pin);
+    busPcmskMask = _BV(digitalPinToPCMSKbit(pin));
+    busPcicrMask = _BV(digitalPinToPCICRbit(pin));
+}
+
+uint8_t OneWireHub::attach(OneWireItem &sensor) {
+    item = &sensor;
+    return 0;
+}
+
+bool OneWireHub::detach(const OneWireItem &sensor) {
+    if (item != &sensor)
+        return false;
+    item = nullptr;
+    return true;
+}
+
+bool OneWireHub::poll(void) {
+    ++counters.polls;
+    host::advance(pollCost);
+
+    if (transactions.empty() || (transactions.front()->at > clock) || (item == nullptr))
+        return false;
+
+    host::Transaction *transaction = transactions.front();
+    transactions.pop_front();
+
+    // Seen too late the low phase is too short for a reset, or already over: no presence
+    const uint64_t latency = clock - transaction->at;
+    if (latency + host::RESET_MIN_US > resetLow) {
+        transaction->missed = true;
+        ++counters.missedResets;
+        updateBus();
+        return false;
+    }
+
+    counters.resetLatencyMax    = max(counters.resetLatencyMax, uint32_t(latency));
+    counters.resetLatencyTotal += latency;
+    serve(*transaction, *this, *item);
+    return true;
+}
+
+bool OneWireHub::send(const uint8_t *address, uint8_t data_length) {
+    if (response == nullptr)
+        return true;
+    response->insert(response->end(), address, address + data_length);
+    return false;
+}
+
+bool OneWireHub::send(const uint8_t *address, uint8_t data_length, uint16_t &crc16) {
+    crc16 = OneWireItem::crc16(address, data_length, crc16);
+    return send(address, data_length);
+}
+
+bool OneWireHub::send(const uint8_t dataByte) {
+    return send(&dataByte, 1);
+}
+
+bool OneWireHub::recv(uint8_t *address, uint8_t data_length) {
+    // Master stopped sending, looks like a reset to the device
+    if ((request == nullptr) || (requestPos + data_length > request->size()))
+        return true;
+
+    memcpy(address, &(*request)[requestPos], data_length);
+    requestPos += data_length;
+    return false;
+}
+
+bool OneWireHub::recv(uint8_t *address, uint8_t data_length, uint16_t &crc16) {
+    if (recv(address, data_length))
+        return true;
+    crc16 = OneWireItem::crc16(address, data_length, crc16);
+    return false;
+}
+
+void OneWireHub::raiseSlaveError(uint8_t) {
+    ++counters.slaveErrors;
+}
@@ -0,0 +1,146 @@
+// Runs the sketch on Linux against the emulated core, see host.h
+//   g++ -std=gnu++14 -O2 -Iextras/host -I. [-DUSE_...] *.cpp extras/host/*.cpp -o mq135_host
+//   ./mq135_host [-s seconds] [-t trace] [-e eeprom] [-m master_ms] [-p poll_us] [-r reset_us] [-v]
+// Feature switches are given with -D as they would be uncommented in the sketch, which itself stays
+// unchanged. The sketch's loop() is timed on the host, the node sees the virtual clock only.
+//   -s  virtual seconds to run loop() for, after setup() and its init delay, default 600
+//   -t  MQ135 trace, lines "seconds value" with raw ADC counts, default a constant 300
+//   -e  EEPROM image, loaded if it exists and saved at the end
+//   -m  master interval: Convert V, then Read Scratchpad page 0, default 10000ms, 0 for no master
+//   -p  cost of one hub.poll() without bus activity in us, default 10
+//   -r  length of the master's reset pulse in us, default 480 (the minimum the master may send)
+//   -v  pass the node's serial output through
+
+// Standard headers first, Arduino.h defines min() and max() as macros
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <unistd.h>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "host.h"
+#include "Address.h"
+#include "DS2438New.h"
+
+void setup();
+void loop();
+void paintStack(void);
+
+extern DS2438New *ds2438;
+
+int main(int argc, char **argv) {
+    uint32_t    seconds  = 600;
+    const char *trace    = nullptr;
+    const char *eeprom   = nullptr;
+    uint32_t    masterMs = 10000;
+    uint32_t    resetLow = 480;
+    bool        verbose  = false;
+
+    int option;
+    while ((option = getopt(argc, argv, "s:t:e:m:p:r:v")) != -1) {
+        switch (option) {
+            case 's': seconds  = strtoul(optarg, nullptr, 10); break;
+            case 't': trace    = optarg; break;
+            case 'e': eeprom   = optarg; break;
+            case 'm': masterMs = strtoul(optarg, nullptr, 10); break;
+            case 'p': host::setPollCost(strtoul(optarg, nullptr, 10)); break;
+            case 'r': resetLow = strtoul(optarg, nullptr, 10); break;
+            case 'v': verbose  = true; break;
+            default:
+                fprintf(stderr, "usage: %s [-s seconds] [-t trace] [-e eeprom] [-m master_ms] [-p poll_us] [-r reset_us] [-v]\n", argv[0]);
+                return 2;
+        }
+    }
+
+    if (trace != nullptr) {
+        if (!host::loadTrace(0, trace)) {
+            fprintf(stderr, "can't read trace %s\n", trace);
+            return 1;
+        }
+    } else {
+        host::setTrace(0, { { 0, 300 } });
+    }
+    host::setSerial(verbose ? stdout : nullptr);
+    host::setResetLow(resetLow);
+
+    // Address generation waits for watchdog interrupts in a busy loop the virtual clock can't see
+    // move, so a blank EEPROM gets a fixed address
+    if ((eeprom == nullptr) || !host::loadEeprom(eeprom)) {
+        const uint8_t address[Address::SIZE] = { 0x4D, 0x51, 0x31, 0x33, 0x35, 0x01 };
+        Address::save(address);
+    }
+
+    // Power-on reset, what .init3 would do on the chip
+    MCUSR = _BV(PORF);
+    paintStack();
+
+    setup();
+    printf("setup done at %.3fs virtual\n", host::now() / 1e6);
+
+    // Master: Convert V, then read page 0 once the conversion had time to finish. The resets land at
+    // random points of the node's loop, so the worst case reset latency shows up
+    host::Transaction convert {}, read {};
+    std::mt19937      random(1);
+    convert.request = { 0xB4 };
+    read.request    = { 0xBE, 0x00 };
+    uint64_t nextMaster = host::now();
+
+    uint64_t loops = 0, hostTotalNs = 0, hostMaxNs = 0, virtualMaxUs = 0;
+    const uint64_t begin = host::now();
+    const uint64_t end   = begin + uint64_t(seconds) * 1000000;
+
+    const auto started = std::chrono::steady_clock::now();
+    while (host::now() < end) {
+        if ((masterMs > 0) && (host::now() >= nextMaster)) {
+            if (read.served && (read.response.size() >= 9)) {
+                const uint8_t *r = read.response.data();
+                printf("%8.1fs VAD %4u temp %7.2f seq %3u crc %s\n", host::now() / 1e6,
+                       unsigned((r[4] & 0x03) << 8 | r[3]), int16_t(r[2] << 8 | r[1]) / 256.0,
+                       unsigned(ds2438->getSequence()),
+                       (OneWireItem::crc8(r, 8) == r[8]) ? "ok" : "bad");
+            }
+
+            convert.at = host::now() + random() % 1000;
+            read.at    = convert.at + 10000 + random() % 1000;
+            host::schedule(convert);
+            host::schedule(read);
+            nextMaster += uint64_t(masterMs) * 1000;
+        }
+
+        const uint64_t virtualStart = host::now();
+        const auto     hostStart    = std::chrono::steady_clock::now();
+
+        loop();
+
+        const uint64_t hostNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - hostStart).count();
+        hostTotalNs += hostNs;
+        hostMaxNs    = max(hostMaxNs, hostNs);
+        virtualMaxUs = max(virtualMaxUs, host::now() - virtualStart);
+        ++loops;
+    }
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    if (eeprom != nullptr)
+        host::saveEeprom(eeprom);
+
+    const host::Stats &stats = host::stats();
+    const uint64_t span = host::now() - begin;
+    printf("\n%llu loops in %.1fs virtual, %.3fs host, %.0fx real time\n", (unsigned long long) loops,
+           span / 1e6, wall, (span / 1e6) / wall);
+    printf("loop() host time: mean %.2fus, max %.2fus\n", loops ? hostTotalNs / 1e3 / loops : 0.0, hostMaxNs / 1e3);
+    printf("loop() virtual time: mean %.1fus, max %lluus\n", loops ? double(span) / loops : 0.0,
+           (unsigned long long) virtualMaxUs);
+    printf("polls %llu, conversions %llu, sleeps %llu (%.1f%% of the time)\n",
+           (unsigned long long) stats.polls, (unsigned long long) stats.conversions, (unsigned long long) stats.sleeps,
+           span ? 100.0 * stats.sleptUs / span : 0.0);
+    printf("transactions %u, slave errors %u, watchdog expiries %u\n",
+           stats.transactions, stats.slaveErrors, stats.watchdogExpiries);
+    printf("reset edge to poll(): mean %.1fus, max %uus, budget %uus, missed resets %u\n",
+           stats.transactions ? double(stats.resetLatencyTotal) / stats.transactions : 0.0, stats.resetLatencyMax,
+           resetLow - host::RESET_MIN_US, stats.missedResets);
+
+    return 0;
+}
@@ -0,0 +1,13 @@
+// RAM for the stack diagnostics: the array is the symbol the linker gives AVR code as __heap_start,
+// RAMEND in avr/io.h points to its last byte
+
+#include <stdint.h>
+
+namespace {
+    constexpr uint16_t RAM_SIZE { 2048 };
+}
+
+uint8_t         hostRam[RAM_SIZE] __asm__("__heap_start");
+uint8_t        *__brkval;
+extern uint8_t * const hostRamEnd;
+uint8_t * const hostRamEnd { hostRam + RAM_SIZE - 1 };
@@ -0,0 +1,3 @@
+// The sketch as a translation unit of the host build, the Arduino IDE adds the same include
+#include <Arduino.h>
+#include "MQ135As1W.ino"
@@ -0,0 +1,34 @@
+// Table driven 1-Wire CRC8 (x^8 + x^5 + x^4 + 1, reflected) for the host tools,
+// same result as OneWireItem::crc8() on the node.
+
+#ifndef ONEWIRE_CRC_H
+#define ONEWIRE_CRC_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace onewire {
+
+    struct Crc8Table {
+        uint8_t value[256];
+
+        constexpr Crc8Table() : value() {
+            for (int i = 0; i < 256; ++i) {
+                uint8_t crc = uint8_t(i);
+                for (int bit = 0; bit < 8; ++bit)
+                    crc = (crc & 0x01) ? uint8_t((crc >> 1) ^ 0x8C) : uint8_t(crc >> 1);
+                value[i] = crc;
+            }
+        }
+    };
+
+    constexpr Crc8Table crc8Table {};
+
+    inline uint8_t crc8(const uint8_t *data, size_t length, uint8_t crc = 0) {
+        while (length--)
+            crc = crc8Table.value[crc ^ *data++];
+        return crc;
+    }
+}
+
+#endif
@@ -0,0 +1,138 @@
+// Decoder for the binary sample stream of the node (STREAM_SAMPLES, see SampleStream.h)
+// reads a raw serial capture and writes CSV: seq,time_us,raw,filtered
+// Frames with a bad CRC are skipped by re-syncing on the next 0xA5 0x5A, sequence gaps are
+// reported on stderr. Capture and output are handled in large blocks, so hours of data take seconds.
+//
+//   g++ -std=c++14 -O2 -o stream_decode stream_decode.cpp
+//   stty -F /dev/ttyUSB0 115200 raw && cat /dev/ttyUSB0 > capture.bin
+//   ./stream_decode capture.bin > capture.csv
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "onewire_crc.h"
+
+namespace {
+
+    constexpr uint8_t SYNC0      { 0xA5 };
+    constexpr uint8_t SYNC1      { 0x5A };
+    constexpr size_t  FRAME_SIZE { 10 };
+
+    constexpr size_t  BLOCK_SIZE { 1 << 20 };
+
+    struct Counters {
+        unsigned long long frames   = 0;
+        unsigned long long crcError = 0;
+        unsigned long long lost     = 0;  // frames missing according to the sequence number
+    };
+
+    // Minimal buffered CSV writer, printf() per field is the bottleneck otherwise
+    class CsvWriter {
+      private:
+        std::vector<char> buffer;
+        size_t            used = 0;
+        FILE             *out;
+
+        void put(unsigned long long value) {
+            char digits[20];
+            int  n = 0;
+            do {
+                digits[n++] = char('0' + value % 10);
+                value /= 10;
+            } while (value);
+            while (n)
+                buffer[used++] = digits[--n];
+        }
+
+      public:
+        explicit CsvWriter(FILE *file) : buffer(BLOCK_SIZE + 128), out(file) {}
+        ~CsvWriter() { flush(); }
+
+        void row(unsigned seq, unsigned long long time, unsigned raw, unsigned filtered) {
+            put(seq);      buffer[used++] = ',';
+            put(time);     buffer[used++] = ',';
+            put(raw);      buffer[used++] = ',';
+            put(filtered); buffer[used++] = '\n';
+            if (used >= BLOCK_SIZE)
+                flush();
+        }
+
+        void text(const char *line) {
+            const size_t length = strlen(line);
+            memcpy(&buffer[used], line, length);
+            used += length;
+        }
+
+        void flush() {
+            fwrite(buffer.data(), 1, used, out);
+            used = 0;
+        }
+    };
+}
+
+int main(int argc, char **argv) {
+    FILE *in = (argc > 1) ? fopen(argv[1], "rb") : stdin;
+    if (in == nullptr) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    CsvWriter csv(stdout);
+    csv.text("seq,time_us,raw,filtered\n");
+
+    Counters           counters;
+    unsigned long long time     = 0;
+    int                sequence = -1;
+
+    // Bytes left over from the previous block are moved to the front
+    std::vector<uint8_t> block(BLOCK_SIZE + FRAME_SIZE);
+    size_t               kept = 0;
+
+    for (;;) {
+        const size_t got = fread(&block[kept], 1, BLOCK_SIZE, in);
+        const size_t end = kept + got;
+        if (got == 0)
+            break;
+
+        size_t pos = 0;
+        while (pos + FRAME_SIZE <= end) {
+            const uint8_t *frame = &block[pos];
+            if ((frame[0] != SYNC0) || (frame[1] != SYNC1)) {
+                ++pos;
+                continue;
+            }
+
+            if (onewire::crc8(&frame[2], FRAME_SIZE - 3) != frame[FRAME_SIZE - 1]) {
+                ++counters.crcError;
+                ++pos;
+                continue;
+            }
+
+            const unsigned seq      = frame[2];
+            const unsigned delta    = frame[3] | (frame[4] << 8);
+            const unsigned raw      = frame[5] | (frame[6] << 8);
+            const unsigned filtered = frame[7] | (frame[8] << 8);
+
+            if (sequence >= 0)
+                counters.lost += (seq - unsigned(sequence) - 1) & 0xFF;
+            sequence = int(seq);
+
+            time += delta;
+            csv.row(seq, time, raw, filtered);
+            ++counters.frames;
+            pos += FRAME_SIZE;
+        }
+
+        kept = end - pos;
+        memmove(&block[0], &block[pos], kept);
+    }
+
+    csv.flush();
+    fprintf(stderr, "%llu frames, %llu CRC errors, %llu frames lost\n",
+            counters.frames, counters.crcError, counters.lost);
+
+    if (in != stdin)
+        fclose(in);
+    return 0;
+}